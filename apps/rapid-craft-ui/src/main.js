@@ -2,6 +2,114 @@ const { app, BrowserWindow, ipcMain } = require("electron");
 const path = require("path");
 const { spawn } = require("child_process");
 
+function analyzerPath() {
+  return path.join(app.getAppPath(), "resources", "rapid-craft-analyzer.exe");
+}
+
+/*
+ * Long-lived `rapid-craft-analyzer --serve` child.
+ * Requests/responses are single JSON lines; responses are matched by id.
+ */
+class AnalyzerDaemon {
+  constructor() {
+    this.proc = null;
+    this.args = [];
+    this.nextId = 1;
+    this.pending = new Map(); // id -> { resolve, reject }
+    this.partial = []; // chunks of the unterminated stdout line
+  }
+
+  // (re)start with the given analyzer args (sources, --jobs, -p, ...)
+  start(args = []) {
+    if (this.proc && JSON.stringify(args) === JSON.stringify(this.args)) return;
+    this.stop();
+
+    this.args = args;
+    this.partial = [];
+    this.proc = spawn(analyzerPath(), ["--serve", ...args], {
+      cwd: app.getAppPath(),
+      shell: false
+    });
+
+    const proc = this.proc;
+    proc.stdout.setEncoding("utf8");
+    proc.stdout.on("data", (chunk) => {
+      if (this.proc === proc) this.onData(chunk);
+    });
+    proc.stderr.setEncoding("utf8");
+    proc.stderr.on("data", (d) => console.error("[analyzer]", d.trimEnd()));
+
+    proc.stdin.on("error", (err) => console.error("[analyzer] stdin:", err.message));
+
+    // a stopped child has already failed its own requests
+    proc.on("close", (code) => {
+      if (this.proc !== proc) return;
+      this.proc = null;
+      this.failAll(new Error(`analyzer exited (code ${code})`));
+    });
+    proc.on("error", (err) => {
+      if (this.proc !== proc) return;
+      this.proc = null;
+      this.failAll(err);
+    });
+  }
+
+  onData(chunk) {
+    // only the new chunk is scanned; a long line is joined once, when it ends
+    let start = 0;
+    for (let nl = chunk.indexOf("\n"); nl !== -1; nl = chunk.indexOf("\n", start)) {
+      this.partial.push(chunk.slice(start, nl));
+      const line = this.partial.join("");
+      this.partial = [];
+      start = nl + 1;
+      this.onLine(line);
+    }
+    if (start < chunk.length) this.partial.push(chunk.slice(start));
+  }
+
+  onLine(line) {
+    if (!line.trim()) return;
+
+    let msg;
+    try {
+      msg = JSON.parse(line);
+    } catch (e) {
+      console.error("[analyzer] bad response:", line);
+      return;
+    }
+
+    const waiter = this.pending.get(msg.id);
+    if (!waiter) return;
+    this.pending.delete(msg.id);
+    waiter.resolve(msg);
+  }
+
+  request(req) {
+    if (!this.proc) this.start(this.args);
+
+    const id = this.nextId++;
+    return new Promise((resolve, reject) => {
+      this.pending.set(id, { resolve, reject });
+      this.proc.stdin.write(JSON.stringify({ ...req, id }) + "\n");
+    });
+  }
+
+  failAll(err) {
+    for (const { reject } of this.pending.values()) reject(err);
+    this.pending.clear();
+  }
+
+  stop() {
+    if (!this.proc) return;
+    const proc = this.proc;
+    this.proc = null;
+    proc.stdin.end(JSON.stringify({ op: "shutdown" }) + "\n");
+    this.failAll(new Error("analyzer restarted"));
+  }
+}
+
+const daemon = new AnalyzerDaemon();
+
 function createWindow() {
   const win = new BrowserWindow({
     width: 1200,
@@ -16,31 +124,37 @@ function createWindow() {
 
 app.whenReady().then(createWindow);
 
-ipcMain.handle("run-analyzer", async (_event, args) => {
-  const analyzerPath = path.join(
-    app.getAppPath(),
-    "resources",
-    "rapid-craft-analyzer.exe"
-  );
+app.on("before-quit", () => daemon.stop());
 
+// one-shot run (e.g. --version); output collected as chunks
+ipcMain.handle("run-analyzer", async (_event, args) => {
   return new Promise((resolve) => {
-    const proc = spawn(analyzerPath, args, {
+    const proc = spawn(analyzerPath(), args, {
       cwd: app.getAppPath(),
       shell: false
     });
 
-    let stdout = "";
-    let stderr = "";
+    const stdout = [];
+    const stderr = [];
 
-    proc.stdout.on("data", (d) => (stdout += d.toString()));
-    proc.stderr.on("data", (d) => (stderr += d.toString()));
+    proc.stdout.on("data", (d) => stdout.push(d));
+    proc.stderr.on("data", (d) => stderr.push(d));
 
     proc.on("close", (code) => {
       resolve({
         code,
-        stdout,
-        stderr
+        stdout: Buffer.concat(stdout).toString(),
+        stderr: Buffer.concat(stderr).toString()
       });
     });
   });
 });
+
+// daemon: start/restart with sources, then analyze / graph requests
+ipcMain.handle("analyzer-start", async (_event, args) => {
+  daemon.start(args);
+});
+
+ipcMain.handle("analyzer-request", async (_event, req) => {
+  return daemon.request(req);
+});
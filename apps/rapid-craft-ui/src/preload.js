@@ -1,5 +1,11 @@
 const { contextBridge, ipcRenderer } = require("electron");
 
 contextBridge.exposeInMainWorld("rapidCraft", {
-  runAnalyzer: (args) => ipcRenderer.invoke("run-analyzer", args)
+  runAnalyzer: (args) => ipcRenderer.invoke("run-analyzer", args),
+
+  // persistent analyzer (--serve)
+  startAnalyzer: (args) => ipcRenderer.invoke("analyzer-start", args),
+  analyze: (files) => ipcRenderer.invoke("analyzer-request", { op: "analyze", files }),
+  getGraph: (root, depth, format = "json") =>
+    ipcRenderer.invoke("analyzer-request", { op: "graph", root, depth, format })
 });
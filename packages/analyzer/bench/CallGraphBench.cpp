@@ -0,0 +1,134 @@
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "CallGraphCollector.h"
+#include "CallGraphEmitter.h"
+
+// ------------------------------
+// rapid-craft-analyzer-bench
+// - generates one C TU with N call sites (default 100k)
+// - "parse"   : SyntaxOnlyAction (frontend cost only)
+// - "collect" : CallGraphFrontendAction; collect - parse ~= collector cost
+// - "emit"    : JSON + PlantUML of the collected graph into a null stream
+// ------------------------------
+
+static void usage() {
+    llvm::outs() <<
+        "rapid-craft-analyzer-bench [--calls N] [--functions N] [--runs N]\n"
+        "                           [--stdlib-leaf] [--indirect-every N]\n"
+        "                           [--emit json|puml|both]   (default json)\n";
+}
+
+static std::string makeTU(size_t nFuncs, size_t nCalls, size_t indirectEvery) {
+    std::string code;
+    code.reserve(nCalls * 16);
+    code += "void *memset(void *, int, unsigned long);\n";
+    code += "typedef void (*fn_t)(void);\n";
+
+    for (size_t i = 0; i < nFuncs; ++i) {
+        code += "void Rte_Runnable_" + std::to_string(i) + "(void);\n";
+    }
+
+    // deterministic LCG so runs are comparable across commits
+    uint64_t x = 0x9E3779B97F4A7C15ull;
+    auto next = [&]() {
+        x = x * 6364136223846793005ull + 1442695040888963407ull;
+        return static_cast<size_t>(x >> 33);
+    };
+
+    const size_t perFunc = (nCalls + nFuncs - 1) / nFuncs;
+    size_t emitted = 0;
+    for (size_t i = 0; i < nFuncs; ++i) {
+        code += "void Rte_Runnable_" + std::to_string(i) + "(void) {\n";
+        code += "    fn_t fp = Rte_Runnable_" + std::to_string(next() % nFuncs) + ";\n";
+        code += "    char buf[8];\n";
+        for (size_t k = 0; k < perFunc && emitted < nCalls; ++k, ++emitted) {
+            if (indirectEvery && emitted % indirectEvery == indirectEvery - 1) {
+                code += "    fp();\n";
+            } else if (emitted % 16 == 15) {
+                code += "    memset(buf, 0, sizeof buf);\n";
+            } else {
+                code += "    Rte_Runnable_" + std::to_string(next() % nFuncs) + "();\n";
+            }
+        }
+        code += "}\n";
+    }
+    return code;
+}
+
+static void report(const char* mode, size_t calls, double sec) {
+    llvm::outs() << llvm::left_justify(mode, 10)
+                 << " calls=" << calls
+                 << " time=" << llvm::format("%.3f", sec) << "s"
+                 << " calls/s=" << llvm::format("%.0f", sec > 0 ? calls / sec : 0.0)
+                 << "\n";
+}
+
+int main(int argc, const char** argv) {
+    size_t nCalls = 100000;
+    size_t nFuncs = 1000;
+    size_t runs = 3;
+    size_t indirectEvery = 50;
+    RcAnalyzerOptions opts;
+    opts.emit = "json";
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        if (a == "--calls" && i + 1 < argc) { nCalls = std::stoul(argv[++i]); continue; }
+        if (a == "--functions" && i + 1 < argc) { nFuncs = std::stoul(argv[++i]); continue; }
+        if (a == "--runs" && i + 1 < argc) { runs = std::stoul(argv[++i]); continue; }
+        if (a == "--indirect-every" && i + 1 < argc) { indirectEvery = std::stoul(argv[++i]); continue; }
+        if (a == "--emit" && i + 1 < argc) { opts.emit = argv[++i]; continue; }
+        if (a == "--stdlib-leaf") { opts.stdlibLeaf = true; continue; }
+        usage();
+        return (a == "--help" || a == "-h") ? 0 : 1;
+    }
+    if (nFuncs == 0) nFuncs = 1;
+    if (runs == 0) runs = 1;
+
+    const std::string code = makeTU(nFuncs, nCalls, indirectEvery);
+    const std::vector<std::string> args = {"-std=c11"};
+    using clock = std::chrono::steady_clock;
+
+    // best of N: the frontend dominates and is noisy
+    double parseBest = 0, collectBest = 0, emitBest = 0;
+    for (size_t r = 0; r < runs; ++r) {
+        auto t0 = clock::now();
+        if (!clang::tooling::runToolOnCodeWithArgs(
+                std::make_unique<clang::SyntaxOnlyAction>(), code, args, "bench.c")) {
+            llvm::errs() << "error: generated TU failed to parse\n";
+            return 1;
+        }
+        double parse = std::chrono::duration<double>(clock::now() - t0).count();
+
+        CallGraphData graph;
+        t0 = clock::now();
+        clang::tooling::runToolOnCodeWithArgs(
+            std::make_unique<CallGraphFrontendAction>(
+                opts, [&graph](CallGraphData&& tu) { graph.merge(std::move(tu)); }),
+            code, args, "bench.c");
+        double collect = std::chrono::duration<double>(clock::now() - t0).count();
+
+        t0 = clock::now();
+        llvm::raw_null_ostream sink;
+        CallGraphEmitter(graph, opts).emit(sink);
+        double emit = std::chrono::duration<double>(clock::now() - t0).count();
+
+        if (r == 0 || parse < parseBest) parseBest = parse;
+        if (r == 0 || collect < collectBest) collectBest = collect;
+        if (r == 0 || emit < emitBest) emitBest = emit;
+    }
+
+    report("parse", nCalls, parseBest);
+    report("collect", nCalls, collectBest);
+    report("collector", nCalls, collectBest > parseBest ? collectBest - parseBest : 0.0);
+    report("emit", nCalls, emitBest);
+    return 0;
+}
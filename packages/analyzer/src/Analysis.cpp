@@ -0,0 +1,87 @@
+#include "Analysis.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "clang/Tooling/Tooling.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+#include "CallGraphCollector.h"
+#include "profile/Profiler.h"
+
+using namespace clang;
+using namespace clang::tooling;
+
+namespace {
+
+class CallGraphActionFactory
+    : public clang::tooling::FrontendActionFactory {
+public:
+    CallGraphActionFactory(const RcAnalyzerOptions& options, CallGraphSink sink,
+                           NdjsonEdgeStream* edges = nullptr)
+        : Opts(options), Sink(std::move(sink)), Edges(edges) {}
+
+    std::unique_ptr<clang::FrontendAction> create() override {
+        return std::make_unique<CallGraphFrontendAction>(Opts, Sink, Edges);
+    }
+
+private:
+    RcAnalyzerOptions Opts;
+    CallGraphSink Sink;
+    NdjsonEdgeStream* Edges;
+};
+
+} // namespace
+
+int analyzeSources(const CompilationDatabase& Compilations,
+                   const std::vector<std::string>& Sources,
+                   const RcAnalyzerOptions& opts,
+                   unsigned jobs,
+                   std::vector<CallGraphData>& results,
+                   NdjsonEdgeStream* edges)
+{
+    if (jobs == 0) jobs = std::thread::hardware_concurrency();
+    if (jobs == 0) jobs = 1;
+    jobs = std::min<unsigned>(jobs, std::max<size_t>(Sources.size(), 1));
+
+    // one slot per source -> merge order does not depend on scheduling
+    results.clear();
+    results.resize(Sources.size());
+    std::vector<int> rcs(Sources.size(), 0);
+    std::atomic<size_t> next{0};
+
+    auto worker = [&] {
+        for (size_t i = next++; i < Sources.size(); i = next++) {
+            // own FS per tool: ClangTool otherwise changes the shared process cwd
+            llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> FS =
+                llvm::vfs::createPhysicalFileSystem();
+            ClangTool Tool(Compilations, {Sources[i]},
+                           std::make_shared<PCHContainerOperations>(), FS);
+
+            CallGraphSink sink;
+            if (!edges) {
+                sink = [&results, i](CallGraphData&& tu) { results[i].merge(std::move(tu)); };
+            }
+            CallGraphActionFactory Factory(opts, sink, edges);
+            ScopedTimer timer("clang.tool"); // parse + sema + ast.visit
+            rcs[i] = Tool.run(&Factory);
+        }
+    };
+
+    if (jobs == 1) {
+        worker();
+    } else {
+        std::vector<std::thread> pool;
+        pool.reserve(jobs);
+        for (unsigned t = 0; t < jobs; ++t) pool.emplace_back(worker);
+        for (auto& t : pool) t.join();
+    }
+
+    Profiler::instance().count("tu", static_cast<int64_t>(Sources.size()));
+
+    int rc = 0;
+    for (int r : rcs) rc = std::max(rc, r);
+    return rc;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "clang/Tooling/CompilationDatabase.h"
+
+#include "CallGraphData.h"
+#include "EdgeStream.h"
+#include "RcAnalyzerOptions.h"
+
+// ------------------------------
+// Run the collector over a list of sources on a worker pool.
+//
+// results[i] receives the graph of Sources[i] (empty on failure), so the
+// caller can merge in source order independent of scheduling.
+// With edges != nullptr call sites are streamed and results stay empty.
+// Returns the highest ClangTool exit code.
+// ------------------------------
+int analyzeSources(const clang::tooling::CompilationDatabase& Compilations,
+                   const std::vector<std::string>& Sources,
+                   const RcAnalyzerOptions& opts,
+                   unsigned jobs,
+                   std::vector<CallGraphData>& results,
+                   NdjsonEdgeStream* edges = nullptr);
@@ -1,89 +1,87 @@
 #pragma once
 
-#include <map>
-#include <set>
+#include <functional>
 #include <string>
-#include <vector>
 
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "llvm/ADT/DenseMap.h"
 
-// ------------------------------
-// Options shared across action/collector
-// ------------------------------
-struct RcAnalyzerOptions {
-    std::string emit = "both";     // json | puml | both
-    bool stdlibLeaf = false;       // include stdlib calls as leaf edges
-    bool indirectLabelVar = false; // (indirect:<expr>) vs (indirect)
-    int sequenceMaxDepth = 5;      // depth for sequence expansion
-    std::string sequenceRoot;      // optional root name
-};
+#include "CallGraphData.h"
+#include "EdgeStream.h"
+#include "RcAnalyzerOptions.h"
 
 class CallGraphCollector : public clang::RecursiveASTVisitor<CallGraphCollector> {
 public:
-    CallGraphCollector(clang::ASTContext& context, const RcAnalyzerOptions& options);
+    // edges != nullptr: call sites are streamed as NDJSON instead of stored
+    CallGraphCollector(clang::ASTContext& context, const RcAnalyzerOptions& options,
+                       CallGraphData& graph, NdjsonEdgeStream* edges = nullptr);
 
     bool VisitFunctionDecl(clang::FunctionDecl* FD);
     bool VisitCallExpr(clang::CallExpr* CE);
 
-    // outputs
-    void dumpAsJson() const;
-    void dumpSequenceAsPlantUml() const;
-
 private:
+    using NameId = CallGraphData::NameId;
+
+    // interned name + leaf classification, resolved once per declaration
+    // (system callees are only interned when they become leaf nodes)
+    struct DeclInfo {
+        NameId id = kNoName;
+        bool system = false;
+        bool resolved = false;
+    };
+    static constexpr NameId kNoName = ~NameId(0);
+
     clang::ASTContext& Context;
     const clang::SourceManager& SM;
     const RcAnalyzerOptions& Opts;
+    CallGraphData& Graph;
+    NdjsonEdgeStream* Edges;
+    std::string TUName; // main file, resolved on the first streamed edge
 
     const clang::FunctionDecl* CurrentFunction = nullptr;
+    NameId CurrentId = 0;
 
-    // callGraph relationship (set)
-    std::map<std::string, std::set<std::string>> CallGraph;
-
-    // call order per function (vector) for sequence generation
-    std::map<std::string, std::vector<std::string>> CallOrder;
-
-    // track all nodes we care about
-    std::set<std::string> Nodes;
+    llvm::DenseMap<const clang::FunctionDecl*, DeclInfo> DeclIds; // canonical decl keys
 
     // helpers
+    DeclInfo internDecl(const clang::FunctionDecl* FD, bool asNode);
+    void record(NameId callee, llvm::StringRef kind);
     bool isUserFunction(const clang::FunctionDecl* FD) const;
-    bool isSystemFunctionName(const std::string& name) const;
     std::string getIndirectLabel(const clang::CallExpr* CE) const;
-
-    void ensureNode(const std::string& name);
-
-    // sequence helpers
-    std::string pickSequenceRoot() const;
-    void emitSeqParticipants(llvm::raw_ostream& os) const;
-    void emitSeqFrom(llvm::raw_ostream& os,
-                     const std::string& caller,
-                     int depth,
-                     std::set<std::string>& stack) const;
 };
 
+// receives each TU's graph once its traversal is done
+using CallGraphSink = std::function<void(CallGraphData&&)>;
+
 // ------------------------------
 // AST Consumer / FrontendAction
 // ------------------------------
 class CallGraphASTConsumer : public clang::ASTConsumer {
 public:
-    CallGraphASTConsumer(clang::ASTContext& context, const RcAnalyzerOptions& options);
+    CallGraphASTConsumer(clang::ASTContext& context, const RcAnalyzerOptions& options,
+                         CallGraphSink sink, NdjsonEdgeStream* edges);
     void HandleTranslationUnit(clang::ASTContext& context) override;
 
 private:
-    const RcAnalyzerOptions& Opts;
+    CallGraphData Graph;      // must precede Collector (it holds a reference)
     CallGraphCollector Collector;
+    CallGraphSink Sink;
+    NdjsonEdgeStream* Edges;
 };
 
 class CallGraphFrontendAction : public clang::ASTFrontendAction {
 public:
-    explicit CallGraphFrontendAction(const RcAnalyzerOptions& options);
+    CallGraphFrontendAction(const RcAnalyzerOptions& options, CallGraphSink sink,
+                            NdjsonEdgeStream* edges = nullptr);
 
     std::unique_ptr<clang::ASTConsumer>
     CreateASTConsumer(clang::CompilerInstance& CI, clang::StringRef) override;
 
 private:
     RcAnalyzerOptions Opts; // stored copy (factory passes by value)
+    CallGraphSink Sink;
+    NdjsonEdgeStream* Edges;
 };
@@ -0,0 +1,107 @@
+#include "CallGraphData.h"
+
+#include <algorithm>
+
+#include "llvm/ADT/StringSet.h"
+
+CallGraphData::NameId CallGraphData::ensureNode(llvm::StringRef name) {
+    auto ins = Ids.try_emplace(name, static_cast<NameId>(Names.size()));
+    if (ins.second) {
+        Names.push_back(ins.first->getKey());
+        CallOrder.emplace_back();
+    }
+    return ins.first->second;
+}
+
+bool CallGraphData::find(llvm::StringRef name, NameId& out) const {
+    auto it = Ids.find(name);
+    if (it == Ids.end()) return false;
+    out = it->second;
+    return true;
+}
+
+std::vector<CallGraphData::NameId> CallGraphData::sortedNodes() const {
+    std::vector<NameId> ids(Names.size());
+    for (NameId i = 0; i < ids.size(); ++i) ids[i] = i;
+    std::sort(ids.begin(), ids.end(),
+              [&](NameId a, NameId b) { return Names[a] < Names[b]; });
+    return ids;
+}
+
+std::vector<CallGraphData::NameId> CallGraphData::sortedCallees(NameId caller) const {
+    std::vector<NameId> ids = CallOrder[caller];
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    std::sort(ids.begin(), ids.end(),
+              [&](NameId a, NameId b) { return Names[a] < Names[b]; });
+    return ids;
+}
+
+void CallGraphData::merge(CallGraphData&& other) {
+    if (empty()) {
+        *this = std::move(other);
+        return;
+    }
+    merge(static_cast<const CallGraphData&>(other));
+}
+
+void CallGraphData::merge(const CallGraphData& other) {
+    // other id -> our id
+    std::vector<NameId> remap(other.Names.size());
+    for (NameId i = 0; i < remap.size(); ++i) {
+        remap[i] = ensureNode(other.Names[i]);
+    }
+
+    for (NameId i = 0; i < remap.size(); ++i) {
+        auto& dst = CallOrder[remap[i]];
+        dst.reserve(dst.size() + other.CallOrder[i].size());
+        for (NameId callee : other.CallOrder[i]) dst.push_back(remap[callee]);
+    }
+}
+
+CallGraphData CallGraphData::subgraph(NameId root, int depth) const {
+    CallGraphData out;
+    std::vector<NameId> remap(Names.size(), ~NameId(0));
+
+    // BFS; a node's order list is copied only when it is expanded
+    std::vector<NameId> level{root};
+    remap[root] = out.ensureNode(Names[root]);
+    for (int d = 0; d < depth && !level.empty(); ++d) {
+        std::vector<NameId> nextLevel;
+        for (NameId n : level) {
+            for (NameId c : CallOrder[n]) {
+                if (remap[c] == ~NameId(0)) {
+                    remap[c] = out.ensureNode(Names[c]);
+                    nextLevel.push_back(c);
+                }
+                out.addCall(remap[n], remap[c]);
+            }
+        }
+        level = std::move(nextLevel);
+    }
+    return out;
+}
+
+bool isSystemFunctionName(llvm::StringRef name) {
+    // very conservative: anything starting with these is almost certainly toolchain/runtime/builtin
+    static const char* const prefixes[] = {
+        "__", "_mingw", "__builtin", "__imp_", "_chkstk", "__security", "__acrt"
+    };
+    for (llvm::StringRef p : prefixes) {
+        if (name.take_front(p.size()) == p) return true;
+    }
+
+    // Treat common C stdlib as "system" for leaf toggle purposes.
+    // This is what you want for design-level graphs.
+    static const llvm::StringSet<> stdlibNames = {
+        "printf", "fprintf", "sprintf", "snprintf", "puts", "putchar",
+        "malloc", "calloc", "realloc", "free",
+        "memcpy", "memset", "memcmp", "strlen", "strcpy", "strncpy",
+        "strcmp", "strncmp", "strcat", "strncat",
+        "fopen", "fclose", "fread", "fwrite", "fflush",
+        "exit", "abort", "assert"
+    };
+    if (stdlibNames.count(name)) return true;
+
+    return false;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+
+// ------------------------------
+// Call graph of one TU, or of the whole program after merge()
+//
+// Names are interned once; everything else is keyed by dense NameId.
+// Nothing here is ordered by name - the emitter sorts at output time.
+// ------------------------------
+struct CallGraphData {
+    using NameId = uint32_t;
+
+    // id -> name (refs point into Ids' keys, stable for the map's lifetime)
+    std::vector<llvm::StringRef> Names;
+
+    // call order per function, for sequence generation; indexed by NameId.
+    // The callee set of the call graph is the de-duplicated list.
+    std::vector<std::vector<NameId>> CallOrder;
+
+    CallGraphData() = default;
+    CallGraphData(CallGraphData&&) = default;
+    CallGraphData& operator=(CallGraphData&&) = default;
+    CallGraphData(const CallGraphData&) = delete;
+    CallGraphData& operator=(const CallGraphData&) = delete;
+
+    size_t size() const { return Names.size(); }
+    bool empty() const { return Names.empty(); }
+
+    // intern (registers a node)
+    NameId ensureNode(llvm::StringRef name);
+    void addCall(NameId caller, NameId callee) { CallOrder[caller].push_back(callee); }
+
+    // lookup without interning
+    bool find(llvm::StringRef name, NameId& out) const;
+
+    // node ids sorted by name (deterministic output order)
+    std::vector<NameId> sortedNodes() const;
+
+    // sorted, de-duplicated callees of one node
+    std::vector<NameId> sortedCallees(NameId caller) const;
+
+    // union with another TU's graph; CallOrder lists are appended
+    // (merge TUs in a fixed order to keep the output deterministic)
+    void merge(CallGraphData&& other);
+    void merge(const CallGraphData& other);
+
+    // nodes reachable from root within depth call levels (root = depth 0)
+    CallGraphData subgraph(NameId root, int depth) const;
+
+private:
+    llvm::StringMap<NameId> Ids;
+};
+
+// toolchain / runtime / C stdlib names (leaf handling)
+bool isSystemFunctionName(llvm::StringRef name);
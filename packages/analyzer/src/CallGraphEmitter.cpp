@@ -0,0 +1,219 @@
+#include "CallGraphEmitter.h"
+
+#include <algorithm>
+#include <cctype>
+
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+CallGraphEmitter::CallGraphEmitter(const CallGraphData& graph, const RcAnalyzerOptions& options)
+    : G(graph), Opts(options) {}
+
+void CallGraphEmitter::emit(llvm::raw_ostream& os) const {
+    if (Opts.emit == "json") {
+        dumpAsJson(os);
+    }
+    else if (Opts.emit == "puml") {
+        dumpSequenceAsPlantUml(os);
+    }
+    else if (Opts.emit == "both") {
+        dumpAsJson(os);
+        os << "\n";
+        dumpSequenceAsPlantUml(os);
+    }
+    else{
+        dumpAsJson(os);
+    }
+}
+
+// ------------------------------
+// JSON output
+// ------------------------------
+void CallGraphEmitter::dumpAsJson(llvm::raw_ostream& os) const {
+    // written straight to os (escaped); only one callee list is alive at a time
+    llvm::json::OStream J(os, 2);
+    writeJson(J);
+    os << "\n";
+}
+
+void CallGraphEmitter::writeJson(llvm::json::OStream& J) const {
+    J.object([&] {
+        J.attributeObject("callGraph", [&] {
+            for (NameId caller : G.sortedNodes()) {
+                J.attributeArray(G.Names[caller], [&] {
+                    for (NameId callee : G.sortedCallees(caller)) {
+                        J.value(G.Names[callee]);
+                    }
+                });
+            }
+        });
+    });
+}
+
+// ------------------------------
+// Sequence Diagram Rules (PlantUML)
+// ------------------------------
+//
+// 규칙 정의(설계용 최소 규칙):
+// 1) Root 함수에서 시작하여 "CallOrder(순서)" 기반으로 메시지 출력.
+// 2) Direct call: caller -> callee : call
+// 3) stdlib: --stdlib-leaf=on 일 때만 메시지로 포함(leaf로만 표시).
+// 4) indirect call: caller -> (indirect) 또는 (indirect:fp)
+// 5) expansion: user 함수에 대해서만 DFS 확장. depth 제한(seq-depth).
+//    - stdlib/indirect는 확장하지 않음.
+// 6) 순환 방지: 현재 call stack에 이미 있으면 더 확장하지 않음.
+// 7) --seq-mode=ref: 이미 같은(또는 더 깊은) depth로 확장한 callee는
+//    다시 펼치지 않고 "ref over caller, callee"로 참조한다.
+//    (diamond 구조에서 지수적으로 커지는 출력을 방지)
+// 8) --seq-max-bytes: 출력 크기 예산. 초과하면 truncated 마커를 남기고
+//    더 이상 메시지를 출력하지 않는다 (activate/deactivate 짝은 유지).
+//
+// 한계(의도적):
+// - 분기/루프/조건문은 현재 단계에서는 모델링하지 않는다.
+// - "관계"가 아니라 "관측된 호출 순서" 기반의 간단 시퀀스만 생성.
+//
+
+std::string CallGraphEmitter::pickSequenceRoot() const {
+    if (!Opts.sequenceRoot.empty()) return Opts.sequenceRoot;
+    NameId id;
+    if (G.find("main", id)) return "main";
+    if (!G.empty()) return G.Names[G.sortedNodes().front()].str();
+    return "main";
+}
+
+static bool isIndirectNode(llvm::StringRef name) {
+    return name.take_front(9) == "(indirect";
+}
+
+static std::string sanitizePumlId(llvm::StringRef name) {
+    std::string id;
+    id.reserve(name.size() + 1);
+
+    for (char c : name) {
+        if (isalnum(static_cast<unsigned char>(c))) {
+            id.push_back(c);
+        } else {
+            id.push_back('_');
+        }
+    }
+
+    // PUML id must not start with digit
+    if (id.empty() || isdigit(static_cast<unsigned char>(id[0]))) {
+        id.insert(id.begin(), '_');
+    }
+
+    return id;
+}
+
+// Participant registry: every node gets one id, assigned once in name order,
+// and the same id is used by the declaration, the messages and (de)activate.
+void CallGraphEmitter::emitSeqParticipants(llvm::raw_ostream& os, SeqState& st) const {
+    llvm::StringSet<> used;
+    st.ids.assign(G.size(), std::string());
+
+    for (NameId n : G.sortedNodes()) {
+        std::string id = sanitizePumlId(G.Names[n]);
+
+        // distinct names can sanitize to the same id ("a.b" / "a_b")
+        if (!used.insert(id).second) {
+            for (unsigned k = 2;; ++k) {
+                std::string cand = id + "_" + std::to_string(k);
+                if (used.insert(cand).second) {
+                    id = std::move(cand);
+                    break;
+                }
+            }
+        }
+
+        // PlantUML participant name quoting
+        os << "participant \"" << G.Names[n] << "\" as " << id << "\n";
+        st.ids[n] = std::move(id);
+    }
+}
+
+bool CallGraphEmitter::overBudget(llvm::raw_ostream& os, SeqState& st) const {
+    if (st.truncated) return true;
+    if (Opts.sequenceMaxBytes == 0) return false;
+    if (os.tell() - st.start < Opts.sequenceMaxBytes) return false;
+
+    st.truncated = true;
+    os << "' ... truncated: sequence output budget of " << Opts.sequenceMaxBytes
+       << " bytes reached (--seq-max-bytes)\n";
+    return true;
+}
+
+void CallGraphEmitter::emitSeqFrom(llvm::raw_ostream& os,
+                                    NameId caller,
+                                    int depth,
+                                    SeqState& st) const {
+    if (depth <= 0) return;
+    if (st.onStack[caller]) return;
+
+    st.onStack[caller] = 1;
+
+    const std::string& callerId = st.ids[caller];
+
+    for (NameId callee : G.CallOrder[caller]) {
+        if (overBudget(os, st)) break;
+
+        const llvm::StringRef calleeName = G.Names[callee];
+        const std::string& calleeId = st.ids[callee];
+        const bool indirect = isIndirectNode(calleeName);
+
+        // message
+        if (indirect) {
+            os << callerId << " ..> " << calleeId << " : indirect call\n";
+        } else {
+            os << callerId << " -> " << calleeId << " : call\n";
+        }
+
+        // expand only if callee is a user function node, not a stdlib/indirect label
+        if (indirect || isSystemFunctionName(calleeName)) continue;
+
+        // ref mode: a subtree already shown at least this deep is referenced, not repeated
+        if (Opts.sequenceRef && depth > 1 && !G.CallOrder[callee].empty() &&
+            !st.onStack[callee] && st.expandedDepth[callee] >= depth - 1) {
+            os << "ref over " << callerId << ", " << calleeId
+               << " : " << calleeName << " (expanded above)\n";
+            continue;
+        }
+
+        os << "activate " << calleeId << "\n";
+        emitSeqFrom(os, callee, depth - 1, st);
+        os << "deactivate " << calleeId << "\n";
+
+        if (st.expandedDepth[callee] < depth - 1) st.expandedDepth[callee] = depth - 1;
+    }
+
+    st.onStack[caller] = 0;
+}
+
+void CallGraphEmitter::dumpSequenceAsPlantUml(llvm::raw_ostream& os) const {
+    const std::string root = pickSequenceRoot();
+    SeqState st;
+    st.start = os.tell();
+
+    os << "@startuml\n";
+    os << "hide footbox\n";
+    os << "skinparam sequenceMessageAlign center\n";
+    os << "title rapid-craft sequence (root: " << root << ", depth: " << Opts.sequenceMaxDepth << ")\n\n";
+
+    emitSeqParticipants(os, st);
+    os << "\n";
+
+    NameId rootId;
+    if (!G.find(root, rootId)) {
+        os << "' root not found: " << root << "\n";
+        os << "@enduml\n";
+        return;
+    }
+
+    os << "activate " << st.ids[rootId] << "\n";
+    st.onStack.assign(G.size(), 0);
+    st.expandedDepth.assign(G.size(), 0);
+    emitSeqFrom(os, rootId, Opts.sequenceMaxDepth, st);
+    os << "deactivate " << st.ids[rootId] << "\n";
+
+    os << "@enduml\n";
+}
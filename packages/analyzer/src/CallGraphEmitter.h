@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "CallGraphData.h"
+#include "RcAnalyzerOptions.h"
+
+namespace llvm {
+class raw_ostream;
+namespace json {
+class OStream;
+}
+}
+
+// ------------------------------
+// JSON / PlantUML output of a (merged) call graph
+// ------------------------------
+class CallGraphEmitter {
+public:
+    CallGraphEmitter(const CallGraphData& graph, const RcAnalyzerOptions& options);
+
+    // json | puml | both, per Opts.emit
+    void emit(llvm::raw_ostream& os) const;
+
+    void dumpAsJson(llvm::raw_ostream& os) const;
+    void writeJson(llvm::json::OStream& J) const; // {"callGraph": {...}} as one value
+    void dumpSequenceAsPlantUml(llvm::raw_ostream& os) const;
+
+private:
+    using NameId = CallGraphData::NameId;
+
+    const CallGraphData& G;
+    const RcAnalyzerOptions& Opts;
+
+    // per-emission sequence state
+    struct SeqState {
+        std::vector<std::string> ids;   // NameId -> PlantUML participant id
+
+        std::vector<char> onStack;
+        std::vector<int> expandedDepth; // deepest expansion emitted so far (ref mode)
+        uint64_t start = 0;             // os.tell() at @startuml
+        bool truncated = false;
+    };
+
+    // sequence helpers
+    std::string pickSequenceRoot() const;
+    void emitSeqParticipants(llvm::raw_ostream& os, SeqState& st) const;
+    void emitSeqFrom(llvm::raw_ostream& os,
+                     NameId caller,
+                     int depth,
+                     SeqState& st) const;
+    bool overBudget(llvm::raw_ostream& os, SeqState& st) const;
+};
@@ -0,0 +1,30 @@
+#include "EdgeStream.h"
+
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+void NdjsonEdgeStream::edge(llvm::StringRef tu, llvm::StringRef caller,
+                            llvm::StringRef callee, llvm::StringRef kind) {
+    // format outside the lock, write the finished line under it
+    llvm::SmallString<128> line;
+    {
+        llvm::raw_svector_ostream ls(line);
+        llvm::json::OStream J(ls);
+        J.object([&] {
+            J.attribute("tu", tu);
+            J.attribute("caller", caller);
+            J.attribute("callee", callee);
+            J.attribute("kind", kind);
+        });
+    }
+    line.push_back('\n');
+
+    std::lock_guard<std::mutex> lk(Mu);
+    OS << line;
+}
+
+void NdjsonEdgeStream::flush() {
+    std::lock_guard<std::mutex> lk(Mu);
+    OS.flush();
+}
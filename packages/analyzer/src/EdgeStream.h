@@ -0,0 +1,33 @@
+#pragma once
+
+#include <mutex>
+
+#include "llvm/ADT/StringRef.h"
+
+namespace llvm {
+class raw_ostream;
+}
+
+// ------------------------------
+// NDJSON edge stream: one JSON object per call site, written while the
+// collector traverses (nothing is kept in memory). Safe to share between
+// --jobs workers; each line is written whole.
+//
+//   {"tu":"a.c","caller":"f","callee":"g","kind":"direct"}
+//
+// kind: direct | stdlib | indirect
+// ------------------------------
+class NdjsonEdgeStream {
+public:
+    explicit NdjsonEdgeStream(llvm::raw_ostream& os) : OS(os) {}
+
+    void edge(llvm::StringRef tu, llvm::StringRef caller,
+              llvm::StringRef callee, llvm::StringRef kind);
+
+    // push buffered lines to the consumer (called after each TU)
+    void flush();
+
+private:
+    std::mutex Mu;
+    llvm::raw_ostream& OS;
+};
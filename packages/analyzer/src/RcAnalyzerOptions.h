@@ -0,0 +1,17 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+// ------------------------------
+// Options shared across action/collector/emitter
+// ------------------------------
+struct RcAnalyzerOptions {
+    std::string emit = "both";     // json | puml | both
+    bool stdlibLeaf = false;       // include stdlib calls as leaf edges
+    bool indirectLabelVar = false; // (indirect:<expr>) vs (indirect)
+    int sequenceMaxDepth = 5;      // depth for sequence expansion
+    std::string sequenceRoot;      // optional root name
+    bool sequenceRef = false;      // expand each callee once, then "ref over"
+    uint64_t sequenceMaxBytes = 16u << 20; // sequence output budget, 0 = unlimited
+};
@@ -0,0 +1,162 @@
+#include "Server.h"
+
+#include <algorithm>
+
+#include "llvm/Support/raw_ostream.h"
+
+#include "Analysis.h"
+#include "CallGraphEmitter.h"
+
+static llvm::StringRef stringField(const llvm::json::Object& o, llvm::StringRef key,
+                                   llvm::StringRef def = "") {
+    if (auto s = o.getString(key)) return *s;
+    return def;
+}
+
+AnalyzerServer::AnalyzerServer(const clang::tooling::CompilationDatabase& compilations,
+                               std::vector<std::string> sources,
+                               const RcAnalyzerOptions& options,
+                               unsigned jobs)
+    : Compilations(compilations), Sources(std::move(sources)), Opts(options), Jobs(jobs) {}
+
+int AnalyzerServer::run(std::istream& in, llvm::raw_ostream& out) {
+    std::string line;
+    bool running = true;
+
+    while (running && std::getline(in, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        llvm::json::OStream J(out); // compact: one response per line
+        llvm::Expected<llvm::json::Value> req = llvm::json::parse(line);
+
+        if (!req || !req->getAsObject()) {
+            std::string err = req ? "request must be a JSON object"
+                                  : llvm::toString(req.takeError());
+            J.object([&] {
+                J.attribute("ok", false);
+                J.attribute("error", err);
+            });
+        } else {
+            running = handle(*req->getAsObject(), J);
+        }
+
+        out << "\n";
+        out.flush();
+    }
+    return 0;
+}
+
+bool AnalyzerServer::handle(const llvm::json::Object& req, llvm::json::OStream& J) {
+    const llvm::StringRef op = stringField(req, "op");
+    bool keepRunning = true;
+
+    J.object([&] {
+        if (const llvm::json::Value* id = req.get("id")) J.attribute("id", *id);
+
+        if (op == "analyze") {
+            opAnalyze(req, J);
+        } else if (op == "graph") {
+            opGraph(req, J);
+        } else if (op == "shutdown") {
+            J.attribute("ok", true);
+            keepRunning = false;
+        } else {
+            J.attribute("ok", false);
+            J.attribute("error", "unknown op: " + op.str());
+        }
+    });
+    return keepRunning;
+}
+
+void AnalyzerServer::opAnalyze(const llvm::json::Object& req, llvm::json::OStream& J) {
+    std::vector<std::string> files;
+    if (const llvm::json::Array* arr = req.getArray("files")) {
+        for (const llvm::json::Value& v : *arr) {
+            if (auto s = v.getAsString()) files.push_back(s->str());
+        }
+    } else {
+        files = Sources;
+    }
+
+    const int rc = analyze(files);
+
+    J.attribute("ok", rc == 0);
+    if (rc != 0) J.attribute("error", "clang returned " + std::to_string(rc));
+    J.attribute("analyzed", static_cast<int64_t>(files.size()));
+    J.attribute("nodes", static_cast<int64_t>(program().size()));
+}
+
+void AnalyzerServer::opGraph(const llvm::json::Object& req, llvm::json::OStream& J) {
+    // first request: nothing parsed yet
+    std::vector<std::string> missing;
+    for (const auto& f : Sources) {
+        if (!PerFile.count(f)) missing.push_back(f);
+    }
+    if (!missing.empty()) analyze(missing);
+
+    const CallGraphData& G = program();
+
+    RcAnalyzerOptions opts = Opts;
+    opts.sequenceRoot = stringField(req, "root").str();
+    if (auto depth = req.getInteger("depth")) {
+        opts.sequenceMaxDepth = static_cast<int>(std::max<int64_t>(*depth, 1));
+    }
+    const llvm::StringRef format = stringField(req, "format", "json");
+
+    CallGraphData::NameId root = 0;
+    if (!opts.sequenceRoot.empty() && !G.find(opts.sequenceRoot, root)) {
+        J.attribute("ok", false);
+        J.attribute("error", "root not found: " + opts.sequenceRoot);
+        return;
+    }
+
+    if (format == "puml") {
+        std::string text;
+        llvm::raw_string_ostream os(text);
+        CallGraphEmitter(G, opts).dumpSequenceAsPlantUml(os);
+        os.flush();
+
+        J.attribute("ok", true);
+        J.attribute("puml", text);
+        return;
+    }
+
+    J.attribute("ok", true);
+    J.attributeBegin("graph");
+    if (opts.sequenceRoot.empty()) {
+        CallGraphEmitter(G, opts).writeJson(J);
+    } else {
+        CallGraphData sub = G.subgraph(root, opts.sequenceMaxDepth);
+        CallGraphEmitter(sub, opts).writeJson(J);
+    }
+    J.attributeEnd();
+}
+
+int AnalyzerServer::analyze(const std::vector<std::string>& files) {
+    for (const auto& f : files) {
+        if (std::find(Sources.begin(), Sources.end(), f) == Sources.end()) {
+            Sources.push_back(f);
+        }
+    }
+
+    std::vector<CallGraphData> results;
+    const int rc = analyzeSources(Compilations, files, Opts, Jobs, results);
+
+    for (size_t i = 0; i < files.size(); ++i) {
+        PerFile[files[i]] = std::move(results[i]);
+    }
+    ProgramDirty = true;
+    return rc;
+}
+
+const CallGraphData& AnalyzerServer::program() {
+    if (ProgramDirty) {
+        Program = CallGraphData();
+        for (const auto& f : Sources) {
+            auto it = PerFile.find(f);
+            if (it != PerFile.end()) Program.merge(it->second);
+        }
+        ProgramDirty = false;
+    }
+    return Program;
+}
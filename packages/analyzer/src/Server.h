@@ -0,0 +1,54 @@
+#pragma once
+
+#include <istream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "clang/Tooling/CompilationDatabase.h"
+#include "llvm/Support/JSON.h"
+
+#include "CallGraphData.h"
+#include "RcAnalyzerOptions.h"
+
+// ------------------------------
+// --serve: long-lived analyzer for the UI.
+//
+// One JSON request per stdin line, one JSON response per stdout line:
+//   {"id":1,"op":"analyze","files":["a.c"]}         re-parse (default: all)
+//   {"id":2,"op":"graph","root":"main","depth":3,"format":"json|puml"}
+//   {"id":3,"op":"shutdown"}
+// Responses echo "id" and carry "ok" (+ "error" when false).
+//
+// Per-TU graphs stay in memory between requests; "analyze" replaces only
+// the files it names and the program graph is re-merged lazily.
+// ------------------------------
+class AnalyzerServer {
+public:
+    AnalyzerServer(const clang::tooling::CompilationDatabase& compilations,
+                   std::vector<std::string> sources,
+                   const RcAnalyzerOptions& options,
+                   unsigned jobs);
+
+    // returns on "shutdown" or EOF
+    int run(std::istream& in, llvm::raw_ostream& out);
+
+private:
+    // false -> stop serving
+    bool handle(const llvm::json::Object& req, llvm::json::OStream& J);
+
+    void opAnalyze(const llvm::json::Object& req, llvm::json::OStream& J);
+    void opGraph(const llvm::json::Object& req, llvm::json::OStream& J);
+
+    int analyze(const std::vector<std::string>& files);
+    const CallGraphData& program();
+
+    const clang::tooling::CompilationDatabase& Compilations;
+    std::vector<std::string> Sources;               // known files, first-seen order
+    std::map<std::string, CallGraphData> PerFile;   // warm per-TU graphs
+    CallGraphData Program;                          // merge of PerFile in Sources order
+    bool ProgramDirty = true;
+
+    RcAnalyzerOptions Opts;
+    unsigned Jobs;
+};
@@ -1,28 +1,20 @@
+#include <iostream>
+#include <vector>
+
 #include "clang/Frontend/FrontendActions.h"
 #include "clang/Tooling/CommonOptionsParser.h"
 #include "clang/Tooling/Tooling.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/raw_ostream.h"
 
-#include "CallGraphCollector.h"
+#include "Analysis.h"
+#include "CallGraphEmitter.h"
+#include "Server.h"
+#include "profile/Profiler.h"
 
 using namespace clang;
 using namespace clang::tooling;
 
-class CallGraphActionFactory
-    : public clang::tooling::FrontendActionFactory {
-public:
-    explicit CallGraphActionFactory(const RcAnalyzerOptions& options)
-        : Opts(options) {}
-
-    std::unique_ptr<clang::FrontendAction> create() override {
-        return std::make_unique<CallGraphFrontendAction>(Opts);
-    }
-
-private:
-    RcAnalyzerOptions Opts;
-};
-
 // ------------------------------
 // CLI options
 // ------------------------------
@@ -30,7 +22,7 @@ static llvm::cl::OptionCategory RapidCraftCategory("rapid-craft-analyzer options
 
 static llvm::cl::opt<std::string> OptEmit(
     "emit",
-    llvm::cl::desc("Output format: json | puml | both"),
+    llvm::cl::desc("Output format: json | puml | both | ndjson (ndjson: one edge per line, streamed while parsing)"),
     llvm::cl::init("json"),
     llvm::cl::cat(RapidCraftCategory));
 
@@ -58,14 +50,98 @@ static llvm::cl::opt<std::string> OptSeqRoot(
     llvm::cl::init(""),
     llvm::cl::cat(RapidCraftCategory));
 
+static llvm::cl::opt<std::string> OptSeqMode(
+    "seq-mode",
+    llvm::cl::desc("Sequence expansion: expand | ref (ref: expand each callee once, then 'ref over')"),
+    llvm::cl::init("expand"),
+    llvm::cl::cat(RapidCraftCategory));
+
+static llvm::cl::opt<uint64_t> OptSeqMaxBytes(
+    "seq-max-bytes",
+    llvm::cl::desc("Sequence diagram output budget in bytes; truncates with a marker (0 = unlimited)"),
+    llvm::cl::init(16u << 20),
+    llvm::cl::cat(RapidCraftCategory));
+
+static llvm::cl::opt<unsigned> OptJobs(
+    "jobs",
+    llvm::cl::desc("Parallel translation units (0 = hardware concurrency)"),
+    llvm::cl::init(1),
+    llvm::cl::cat(RapidCraftCategory));
+
+static llvm::cl::opt<bool> OptServe(
+    "serve",
+    llvm::cl::desc("Serve line-delimited JSON requests on stdin/stdout (keeps per-TU graphs warm)"),
+    llvm::cl::init(false),
+    llvm::cl::cat(RapidCraftCategory));
+
 static llvm::cl::opt<bool> OptNoCompileDbWarn(
     "no-compile-db-warning",
     llvm::cl::desc("Suppress compilation database warning"),
     llvm::cl::init(false),
     llvm::cl::cat(RapidCraftCategory));
 
+// ------------------------------
+// Batch mode: analyze everything, merge, emit once
+// ------------------------------
+static int runAnalysis(const CompilationDatabase& Compilations,
+                       const std::vector<std::string>& Sources,
+                       const RcAnalyzerOptions& opts,
+                       unsigned jobs)
+{
+    // ndjson: edges go straight to stdout during traversal, nothing is merged
+    if (opts.emit == "ndjson") {
+        NdjsonEdgeStream edges(llvm::outs());
+        std::vector<CallGraphData> unused;
+        return analyzeSources(Compilations, Sources, opts, jobs, unused, &edges);
+    }
+
+    std::vector<CallGraphData> results;
+    int rc = analyzeSources(Compilations, Sources, opts, jobs, results);
+
+    CallGraphData program;
+    {
+        ScopedTimer timer("merge");
+        for (auto& r : results) program.merge(std::move(r));
+    }
+
+    {
+        ScopedTimer timer("emit");
+        CallGraphEmitter(program, opts).emit(llvm::outs());
+        llvm::outs().flush();
+    }
+    Profiler::instance().count("nodes", static_cast<int64_t>(program.size()));
+    return rc;
+}
+
+static int run(const CompilationDatabase& Compilations,
+               const std::vector<std::string>& Sources,
+               const RcAnalyzerOptions& opts)
+{
+    int rc;
+    if (OptServe) {
+        AnalyzerServer server(Compilations, Sources, opts, OptJobs);
+        rc = server.run(std::cin, llvm::outs());
+    } else {
+        rc = runAnalysis(Compilations, Sources, opts, OptJobs);
+    }
+    llvm::outs().flush();
+    Profiler::instance().report();
+    return rc;
+}
+
 int main(int argc, const char **argv)
 {
+    // --stats[=json] / --trace <file>: 공용 profiler 옵션.
+    // LLVM 자체 -stats 옵션과 겹치므로 llvm::cl 이전에 걸러낸다.
+    std::vector<const char*> Argv{argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        if (!Profiler::instance().parseArg(argc, argv, i)) {
+            Argv.push_back(argv[i]);
+        }
+    }
+    argc = static_cast<int>(Argv.size());
+    argv = Argv.data();
+
     std::vector<const char*> OptArgv;
     OptArgv.push_back(argv[0]); // program name
 
@@ -93,6 +169,8 @@ int main(int argc, const char **argv)
     opts.indirectLabelVar = (OptIndirectLabel == "var");
     opts.sequenceMaxDepth = (OptSeqDepth < 1 ? 1 : OptSeqDepth);
     opts.sequenceRoot = OptSeqRoot;
+    opts.sequenceRef = (OptSeqMode == "ref");
+    opts.sequenceMaxBytes = OptSeqMaxBytes;
 
     // 1) Try normal CommonOptionsParser (compile_commands.json)
     auto ExpectedParser =
@@ -100,15 +178,8 @@ int main(int argc, const char **argv)
 
     if (ExpectedParser) {
         CommonOptionsParser &OptionsParser = ExpectedParser.get();
-        ClangTool Tool(
-            OptionsParser.getCompilations(),
-            OptionsParser.getSourcePathList()
-        );
-
-        auto Factory =
-            std::make_unique<CallGraphActionFactory>(opts);
-
-        return Tool.run(Factory.get());
+        return run(OptionsParser.getCompilations(),
+                   OptionsParser.getSourcePathList(), opts);
     }
 
     // 2) Fallback: no compilation database
@@ -127,7 +198,8 @@ int main(int argc, const char **argv)
         }
     }
 
-    if (Sources.empty()) {
+    // --serve may start empty and receive files with "analyze"
+    if (Sources.empty() && !OptServe) {
         llvm::errs() << "error: no input files\n";
         return 1;
     }
@@ -137,10 +209,5 @@ int main(int argc, const char **argv)
         ".", std::vector<std::string>{"-std=c11"}
     );
 
-    ClangTool Tool(Compilations, Sources);
-
-    auto Factory =
-        std::make_unique<CallGraphActionFactory>(opts);
-
-    return Tool.run(Factory.get());
+    return run(Compilations, Sources, opts);
 }
\ No newline at end of file
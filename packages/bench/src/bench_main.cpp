@@ -0,0 +1,348 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#endif
+
+#include "corpus_gen.h"
+
+/*
+ * ============================================================
+ * rapid-craft-bench
+ * - generates a synthetic C corpus per shape (corpus_gen.h)
+ * - times the tools end to end on it (best / median of --runs):
+ *     index      : sud-indexer, empty DB, every TU parsed
+ *     reindex    : sud-indexer again, every TU unchanged
+ *     analyze    : rapid-craft-analyzer --emit json
+ *     call-graph : sud-call-graph, whole graph / rooted at main
+ *     sequence   : sud-sequence-diagram main
+ * - JSON result (one object per run of the harness) with the
+ *   corpus parameters, timings and each tool's --stats=json
+ * Tools not built (or not given) are skipped.
+ * ============================================================
+ */
+
+#ifndef RAPID_BENCH_INDEXER
+#define RAPID_BENCH_INDEXER ""
+#endif
+#ifndef RAPID_BENCH_ANALYZER
+#define RAPID_BENCH_ANALYZER ""
+#endif
+#ifndef RAPID_BENCH_CALL_GRAPH
+#define RAPID_BENCH_CALL_GRAPH ""
+#endif
+#ifndef RAPID_BENCH_SEQUENCE
+#define RAPID_BENCH_SEQUENCE ""
+#endif
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+static void usage() {
+  std::cout <<
+    "rapid-craft-bench [--out <dir>] [--json <file>] [--label <text>]\n"
+    "                  [--files N] [--functions N] [--fanout N]\n"
+    "                  [--shape chain|tree|dag|cyclic|all] [--fnptr P]\n"
+    "                  [--header-depth N] [--seed N]\n"
+    "                  [--jobs N] [--runs N] [--gen-only]\n"
+    "                  [--indexer <exe>] [--analyzer <exe>]\n"
+    "                  [--call-graph <exe>] [--sequence-diagram <exe>]\n"
+    "\n"
+    "  --out       working directory, one corpus per shape (default rapid-craft-bench.out)\n"
+    "  --json      result file (default: stdout)\n"
+    "  --label     free text stored in the result (e.g. commit id)\n"
+    "  --functions functions per file (default 20)\n"
+    "  --fnptr     share of call sites made through function pointers (default 0.1)\n"
+    "  --runs      timed runs per step; min and median are reported (default 3)\n"
+    "  --gen-only  write the corpus and exit\n";
+}
+
+struct Tools {
+  std::string indexer = RAPID_BENCH_INDEXER;
+  std::string analyzer = RAPID_BENCH_ANALYZER;
+  std::string callGraph = RAPID_BENCH_CALL_GRAPH;
+  std::string sequence = RAPID_BENCH_SEQUENCE;
+};
+
+struct StepResult {
+  std::string name;
+  int exitCode = 0;
+  std::vector<double> ms;
+  std::string stats;   // tool's --stats=json line, verbatim
+};
+
+static std::string quote(const std::string& s) {
+  return "\"" + s + "\"";
+}
+
+static std::string jsonStr(const std::string& s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+
+static int runCommand(std::string cmd) {
+#ifdef _WIN32
+  // cmd.exe strips the outer quotes of the whole line
+  cmd = "\"" + cmd + "\"";
+#endif
+  const int rc = std::system(cmd.c_str());
+#ifndef _WIN32
+  if (rc != -1 && WIFEXITED(rc)) return WEXITSTATUS(rc);
+#endif
+  return rc;
+}
+
+// last {"wallMs":...} line the tool wrote to stderr
+static std::string readStats(const fs::path& errFile) {
+  std::ifstream is(errFile);
+  std::string line;
+  std::string stats;
+  while (std::getline(is, line)) {
+    if (line.rfind("{\"wallMs\"", 0) == 0) stats = line;
+  }
+  return stats;
+}
+
+static void removeDb(const fs::path& db) {
+  std::error_code ec;
+  for (const char* suffix : { "", "-wal", "-shm", "-journal" })
+    fs::remove(db.string() + suffix, ec);
+}
+
+/* ------------------------------------------------------------
+ * One timed step: `runs` executions of cmd (prepare() before each),
+ * stdout/stderr to <logs>/<name>.out|.err
+ * ------------------------------------------------------------ */
+template <class Prepare>
+static StepResult timeStep(const std::string& name, const std::string& cmd,
+                           const fs::path& logs, std::size_t runs, Prepare prepare) {
+  StepResult r;
+  r.name = name;
+
+  const fs::path out = logs / (name + ".out");
+  const fs::path err = logs / (name + ".err");
+  const std::string full = cmd + " --stats=json > " + quote(out.string())
+                         + " 2> " + quote(err.string());
+
+  for (std::size_t i = 0; i < runs; ++i) {
+    prepare();
+    const auto t0 = Clock::now();
+    r.exitCode = runCommand(full);
+    r.ms.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+    if (r.exitCode != 0) break;
+  }
+  r.stats = readStats(err);
+
+  std::sort(r.ms.begin(), r.ms.end());
+  std::cerr << "  " << std::left << std::setw(18) << name << std::right
+            << std::fixed << std::setprecision(1)
+            << " min=" << std::setw(9) << r.ms.front() << "ms"
+            << " median=" << std::setw(9) << r.ms[r.ms.size() / 2] << "ms"
+            << (r.exitCode ? "  (exit " + std::to_string(r.exitCode) + ")" : std::string())
+            << "\n" << std::defaultfloat;
+  return r;
+}
+
+static StepResult timeStep(const std::string& name, const std::string& cmd,
+                           const fs::path& logs, std::size_t runs) {
+  return timeStep(name, cmd, logs, runs, [] {});
+}
+
+/* ------------------------------------------------------------
+ * JSON output
+ * ------------------------------------------------------------ */
+static void writeCase(std::ostream& os, const CorpusSpec& spec, const CorpusStats& st,
+                      double genMs, const std::vector<StepResult>& steps) {
+  const std::size_t callSites = st.directCalls + st.indirectCalls;
+
+  os << "    {\"shape\":" << jsonStr(shapeName(spec.shape))
+     << ",\"files\":" << spec.files
+     << ",\"functionsPerFile\":" << spec.functionsPerFile
+     << ",\"fanout\":" << spec.fanout
+     << ",\"fnPtrDensity\":" << spec.fnPtrDensity
+     << ",\"headerDepth\":" << spec.headerDepth
+     << ",\"seed\":" << spec.seed
+     << ",\n     \"corpus\":{\"functions\":" << st.functions
+     << ",\"directCalls\":" << st.directCalls
+     << ",\"indirectCalls\":" << st.indirectCalls
+     << ",\"bytes\":" << st.bytes
+     << ",\"genMs\":" << genMs << "},\n"
+     << "     \"steps\":[";
+
+  for (std::size_t i = 0; i < steps.size(); ++i) {
+    const StepResult& s = steps[i];
+    const double minMs = s.ms.front();
+    os << (i ? ",\n" : "\n")
+       << "      {\"name\":" << jsonStr(s.name)
+       << ",\"exitCode\":" << s.exitCode
+       << ",\"runs\":" << s.ms.size()
+       << ",\"minMs\":" << minMs
+       << ",\"medianMs\":" << s.ms[s.ms.size() / 2]
+       << ",\"maxMs\":" << s.ms.back()
+       << ",\"callSitesPerSec\":" << (minMs > 0 ? callSites * 1000.0 / minMs : 0.0);
+    if (!s.stats.empty()) os << ",\"stats\":" << s.stats;
+    os << "}";
+  }
+  os << "\n     ]}";
+}
+
+int main(int argc, char** argv) {
+  std::string outDir = "rapid-craft-bench.out";
+  std::string jsonPath;
+  std::string label;
+  std::string shapeArg = "dag";
+  CorpusSpec base;
+  unsigned jobs = 0;
+  std::size_t runs = 3;
+  bool genOnly = false;
+  Tools tools;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    const bool hasValue = i + 1 < argc;
+    if (a == "--out" && hasValue) { outDir = argv[++i]; continue; }
+    if (a == "--json" && hasValue) { jsonPath = argv[++i]; continue; }
+    if (a == "--label" && hasValue) { label = argv[++i]; continue; }
+    if (a == "--files" && hasValue) { base.files = std::stoul(argv[++i]); continue; }
+    if (a == "--functions" && hasValue) { base.functionsPerFile = std::stoul(argv[++i]); continue; }
+    if (a == "--fanout" && hasValue) { base.fanout = std::stoul(argv[++i]); continue; }
+    if (a == "--shape" && hasValue) { shapeArg = argv[++i]; continue; }
+    if (a == "--fnptr" && hasValue) { base.fnPtrDensity = std::stod(argv[++i]); continue; }
+    if (a == "--header-depth" && hasValue) { base.headerDepth = std::stoul(argv[++i]); continue; }
+    if (a == "--seed" && hasValue) { base.seed = std::stoull(argv[++i]); continue; }
+    if (a == "--jobs" && hasValue) { jobs = (unsigned)std::stoul(argv[++i]); continue; }
+    if (a == "--runs" && hasValue) { runs = std::max<std::size_t>(1, std::stoul(argv[++i])); continue; }
+    if (a == "--gen-only") { genOnly = true; continue; }
+    if (a == "--indexer" && hasValue) { tools.indexer = argv[++i]; continue; }
+    if (a == "--analyzer" && hasValue) { tools.analyzer = argv[++i]; continue; }
+    if (a == "--call-graph" && hasValue) { tools.callGraph = argv[++i]; continue; }
+    if (a == "--sequence-diagram" && hasValue) { tools.sequence = argv[++i]; continue; }
+    usage();
+    return (a == "--help" || a == "-h") ? 0 : 1;
+  }
+
+  std::vector<CorpusShape> shapes;
+  if (shapeArg == "all") {
+    shapes = { CorpusShape::Chain, CorpusShape::Tree, CorpusShape::Dag, CorpusShape::Cyclic };
+  } else {
+    CorpusShape s;
+    if (!parseShape(shapeArg, s)) {
+      std::cerr << "unknown shape: " << shapeArg << "\n";
+      return 1;
+    }
+    shapes.push_back(s);
+  }
+
+  auto usable = [](const std::string& exe) {
+    std::error_code ec;
+    return !exe.empty() && fs::exists(exe, ec);
+  };
+
+  std::ostringstream cases;
+  int worst = 0;
+
+  for (std::size_t c = 0; c < shapes.size(); ++c) {
+    CorpusSpec spec = base;
+    spec.shape = shapes[c];
+
+    const fs::path dir = fs::absolute(fs::path(outDir) / shapeName(spec.shape));
+    const fs::path logs = dir / "logs";
+    const fs::path db = dir / "bench.db";
+
+    std::cerr << "[" << shapeName(spec.shape) << "] " << spec.files << " files x "
+              << spec.functionsPerFile << " functions, fanout " << spec.fanout << "\n";
+
+    CorpusStats st;
+    const auto t0 = Clock::now();
+    try {
+      st = generateCorpus(spec, dir.string());
+    } catch (const std::exception& e) {
+      std::cerr << "[FAIL] corpus: " << e.what() << "\n";
+      return 1;
+    }
+    const double genMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    std::cerr << "  corpus: " << st.functions << " functions, "
+              << st.directCalls << " direct + " << st.indirectCalls << " indirect calls, "
+              << st.bytes / 1024 << " KiB\n";
+    if (genOnly) continue;
+
+    fs::create_directories(logs);
+    const std::string jobsArg = " --jobs " + std::to_string(jobs);
+    std::vector<StepResult> steps;
+
+    if (usable(tools.indexer)) {
+      const std::string cmd = quote(tools.indexer) + " --db " + quote(db.string())
+                            + " --compdb " + quote(dir.string()) + jobsArg;
+      steps.push_back(timeStep("index", cmd, logs, runs, [&] { removeDb(db); }));
+      steps.push_back(timeStep("reindex", cmd, logs, runs));
+    }
+
+    if (usable(tools.analyzer)) {
+      // source list through a response file (command line limits)
+      const fs::path rsp = dir / "sources.rsp";
+      {
+        std::ofstream os(rsp);
+        for (const auto& s : st.sources) os << quote(s) << "\n";
+      }
+      const std::string cmd = quote(tools.analyzer) + " -p " + quote(dir.string())
+                            + " --emit json" + jobsArg + " @" + quote(rsp.string());
+      steps.push_back(timeStep("analyze", cmd, logs, runs));
+    }
+
+    const bool haveDb = !steps.empty() && steps.front().name == "index" && steps.front().exitCode == 0;
+    if (haveDb && usable(tools.callGraph)) {
+      const std::string cmd = quote(tools.callGraph) + " --db " + quote(db.string());
+      steps.push_back(timeStep("call-graph", cmd + " --out " + quote((dir / "call-graph.puml").string()),
+                               logs, runs));
+      steps.push_back(timeStep("call-graph.rooted",
+                               cmd + " --root main --depth 4 --out " + quote((dir / "call-graph.main.puml").string()),
+                               logs, runs));
+    }
+    if (haveDb && usable(tools.sequence)) {
+      const std::string cmd = quote(tools.sequence) + " " + quote(db.string()) + " main "
+                            + quote((dir / "sequence.puml").string());
+      steps.push_back(timeStep("sequence", cmd, logs, runs));
+    }
+
+    if (steps.empty()) {
+      std::cerr << "  no tools found (see --indexer / --analyzer / ...)\n";
+    }
+    for (const auto& s : steps) worst = std::max(worst, s.exitCode);
+
+    if (c) cases << ",\n";
+    writeCase(cases, spec, st, genMs, steps);
+  }
+
+  if (genOnly) return 0;
+
+  std::ostringstream result;
+  result << "{\"label\":" << jsonStr(label)
+         << ",\"jobs\":" << jobs
+         << ",\"runs\":" << runs
+         << ",\"cases\":[\n" << cases.str() << "\n]}\n";
+
+  if (jsonPath.empty()) {
+    std::cout << result.str();
+  } else {
+    std::ofstream os(jsonPath, std::ios::trunc);
+    os << result.str();
+    if (!os) {
+      std::cerr << "cannot write " << jsonPath << "\n";
+      return 1;
+    }
+  }
+  return worst ? 1 : 0;
+}
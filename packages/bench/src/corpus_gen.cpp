@@ -0,0 +1,194 @@
+#include "corpus_gen.h"
+
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+const char* shapeName(CorpusShape s) {
+  switch (s) {
+    case CorpusShape::Chain: return "chain";
+    case CorpusShape::Tree: return "tree";
+    case CorpusShape::Dag: return "dag";
+    case CorpusShape::Cyclic: return "cyclic";
+  }
+  return "?";
+}
+
+bool parseShape(const std::string& name, CorpusShape& out) {
+  for (CorpusShape s : { CorpusShape::Chain, CorpusShape::Tree, CorpusShape::Dag, CorpusShape::Cyclic }) {
+    if (name == shapeName(s)) {
+      out = s;
+      return true;
+    }
+  }
+  return false;
+}
+
+namespace {
+
+// deterministic LCG so corpora are identical across runs and platforms
+struct Lcg {
+  std::uint64_t x;
+  explicit Lcg(std::uint64_t seed) : x(seed * 0x9E3779B97F4A7C15ull + 1) {}
+  std::size_t next() {
+    x = x * 6364136223846793005ull + 1442695040888963407ull;
+    return (std::size_t)(x >> 33);
+  }
+  // uniform in [0, 1)
+  double unit() { return (double)(next() & 0xFFFFFF) / (double)0x1000000; }
+};
+
+std::string fnName(std::size_t g, std::size_t perFile) {
+  return "f" + std::to_string(g / perFile) + "_" + std::to_string(g % perFile);
+}
+
+std::string jsonStr(const std::string& s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+
+std::size_t writeFile(const fs::path& p, const std::string& text) {
+  std::ofstream os(p, std::ios::binary | std::ios::trunc);
+  os << text;
+  if (!os) throw std::runtime_error("cannot write " + p.string());
+  return text.size();
+}
+
+// callees of function g (global index) for the requested shape
+void calleesOf(const CorpusSpec& spec, std::size_t g, std::size_t n, Lcg& rng,
+               std::vector<std::size_t>& out) {
+  out.clear();
+  const std::size_t fanout = spec.fanout ? spec.fanout : 1;
+
+  switch (spec.shape) {
+    case CorpusShape::Chain:
+      if (g + 1 < n) out.push_back(g + 1);
+      break;
+    case CorpusShape::Tree:
+      for (std::size_t k = 1; k <= fanout && g * fanout + k < n; ++k)
+        out.push_back(g * fanout + k);
+      break;
+    case CorpusShape::Dag:
+      if (g + 1 < n) {
+        for (std::size_t k = 0; k < fanout; ++k)
+          out.push_back(g + 1 + rng.next() % (n - g - 1));
+      }
+      break;
+    case CorpusShape::Cyclic:
+      for (std::size_t k = 0; k < fanout; ++k)
+        out.push_back(rng.next() % n);
+      break;
+  }
+}
+
+} // namespace
+
+CorpusStats generateCorpus(const CorpusSpec& spec, const std::string& outDir) {
+  const std::size_t perFile = spec.functionsPerFile ? spec.functionsPerFile : 1;
+  const std::size_t nFiles = spec.files ? spec.files : 1;
+  const std::size_t n = nFiles * perFile;
+
+  const fs::path root = fs::absolute(outDir);
+  const fs::path srcDir = root / "src";
+  const fs::path incDir = root / "include";
+  fs::create_directories(srcDir);
+  fs::create_directories(incDir);
+
+  CorpusStats st;
+  st.functions = n;
+  Lcg rng(spec.seed);
+
+  /* ---- common include chain: common_0.h -> common_1.h -> ... ---- */
+  for (std::size_t d = 0; d < spec.headerDepth; ++d) {
+    std::ostringstream h;
+    h << "#ifndef GEN_COMMON_" << d << "_H\n"
+      << "#define GEN_COMMON_" << d << "_H\n";
+    if (d + 1 < spec.headerDepth) h << "#include \"common_" << (d + 1) << ".h\"\n";
+    h << "\n#define GEN_LEVEL_" << d << " " << d << "\n"
+      << "typedef struct { int id; int level; unsigned flags; } gen_obj_" << d << "_t;\n"
+      << "typedef enum { GEN_E" << d << "_A, GEN_E" << d << "_B, GEN_E" << d << "_C } gen_enum_" << d << "_t;\n"
+      << "extern int gen_common_" << d << "(const gen_obj_" << d << "_t* obj);\n"
+      << "\n#endif\n";
+    st.bytes += writeFile(incDir / ("common_" + std::to_string(d) + ".h"), h.str());
+  }
+
+  /* ---- per-file headers ---- */
+  for (std::size_t f = 0; f < nFiles; ++f) {
+    std::ostringstream h;
+    h << "#ifndef GEN_FILE_" << f << "_H\n"
+      << "#define GEN_FILE_" << f << "_H\n";
+    if (spec.headerDepth > 0) h << "#include \"common_0.h\"\n";
+    h << "\n#ifndef GEN_FN_T_DEFINED\n"
+      << "#define GEN_FN_T_DEFINED\n"
+      << "typedef int (*gen_fn_t)(int);\n"
+      << "#endif\n\n";
+    for (std::size_t k = 0; k < perFile; ++k)
+      h << "int " << fnName(f * perFile + k, perFile) << "(int x);\n";
+    h << "\n#endif\n";
+    st.bytes += writeFile(incDir / ("file_" + std::to_string(f) + ".h"), h.str());
+  }
+
+  /* ---- sources ---- */
+  std::vector<std::size_t> callees;
+  std::ostringstream cdb;
+  cdb << "[\n";
+
+  for (std::size_t f = 0; f < nFiles; ++f) {
+    std::ostringstream body;
+    std::set<std::size_t> includes = { f };
+
+    for (std::size_t k = 0; k < perFile; ++k) {
+      const std::size_t g = f * perFile + k;
+      calleesOf(spec, g, n, rng, callees);
+
+      body << "\nint " << fnName(g, perFile) << "(int x) {\n"
+           << "  int r = x;\n";
+      for (std::size_t c = 0; c < callees.size(); ++c) {
+        const std::size_t callee = callees[c];
+        includes.insert(callee / perFile);
+
+        if (rng.unit() < spec.fnPtrDensity) {
+          body << "  gen_fn_t p" << c << " = " << fnName(callee, perFile) << ";\n"
+               << "  if (x != " << c << ") r += p" << c << "(r + " << c << ");\n";
+          ++st.indirectCalls;
+        } else {
+          body << "  if (x != " << c << ") r += " << fnName(callee, perFile) << "(r + " << c << ");\n";
+          ++st.directCalls;
+        }
+      }
+      body << "  return r;\n}\n";
+    }
+
+    if (f == 0) {
+      body << "\nint main(void) {\n"
+           << "  return " << fnName(0, perFile) << "(0);\n}\n";
+    }
+
+    std::ostringstream src;
+    for (std::size_t inc : includes)
+      src << "#include \"file_" << inc << ".h\"\n";
+    src << body.str();
+
+    const fs::path file = srcDir / ("file_" + std::to_string(f) + ".c");
+    st.bytes += writeFile(file, src.str());
+    st.sources.push_back(file.generic_string());
+
+    cdb << "  {\"directory\": " << jsonStr(root.generic_string())
+        << ", \"file\": " << jsonStr(file.generic_string())
+        << ", \"arguments\": [\"cc\", \"-std=c11\", \"-Iinclude\", \"-c\", "
+        << jsonStr(file.generic_string()) << "]}"
+        << (f + 1 < nFiles ? ",\n" : "\n");
+  }
+
+  cdb << "]\n";
+  writeFile(root / "compile_commands.json", cdb.str());
+  return st;
+}
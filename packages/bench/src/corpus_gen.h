@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/*
+ * ============================================================
+ * Synthetic C corpus (deterministic for a given spec + seed)
+ * - <out>/src/file_<i>.c      : functions + calls
+ * - <out>/include/file_<i>.h  : prototypes of file_<i>.c
+ * - <out>/include/common_<d>.h: nested include chain (headerDepth)
+ * - <out>/compile_commands.json
+ * Function g (global index) calls callees chosen by the shape:
+ *   chain  : g -> g+1
+ *   tree   : g -> g*fanout+1 .. g*fanout+fanout
+ *   dag    : fanout random callees with a larger index
+ *   cyclic : fanout random callees anywhere (back edges + self loops)
+ * main() in file_0.c calls function 0 (root for diagrams).
+ * ============================================================
+ */
+enum class CorpusShape { Chain, Tree, Dag, Cyclic };
+
+const char* shapeName(CorpusShape s);
+// "chain" | "tree" | "dag" | "cyclic"; false if unknown
+bool parseShape(const std::string& name, CorpusShape& out);
+
+struct CorpusSpec {
+  std::size_t files = 100;
+  std::size_t functionsPerFile = 20;
+  std::size_t fanout = 3;
+  CorpusShape shape = CorpusShape::Dag;
+  double fnPtrDensity = 0.1;     // share of call sites made through a function pointer
+  std::size_t headerDepth = 4;   // nested common_<d>.h includes per TU
+  std::uint64_t seed = 1;
+};
+
+struct CorpusStats {
+  std::size_t functions = 0;     // without main
+  std::size_t directCalls = 0;
+  std::size_t indirectCalls = 0;
+  std::size_t bytes = 0;         // total generated source + header size
+  std::vector<std::string> sources;
+};
+
+// Writes the corpus under outDir (created, existing files overwritten).
+// Throws std::runtime_error on I/O failure.
+CorpusStats generateCorpus(const CorpusSpec& spec, const std::string& outDir);
@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <sqlite3.h>
+
+#include "storage/SqliteStore.h"
+
+/*
+ * ============================================================
+ * sud-store-bench
+ * - synthetic SudModel (default: 10k functions, 1M calls)
+ * - "legacy"  : the pre-transaction write path, reproduced here:
+ *               original text-keyed schema, default journal, one
+ *               autocommit per row
+ * - "batched" : SqliteStore with IndexingSession + batched
+ *               transactions
+ * - both modes write the same sample (the first --legacy-rows
+ *   calls and the functions they reference); "batched" then also
+ *   writes the whole model ("full")
+ * ============================================================
+ */
+
+// unsigned decimal only ("-1" would wrap in stoul)
+static bool parseCount(const char* s, std::size_t& out) {
+  if (*s < '0' || *s > '9') return false;
+  char* end = nullptr;
+  errno = 0;
+  const unsigned long long v = std::strtoull(s, &end, 10);
+  if (errno || *end) return false;
+  out = (std::size_t)v;
+  return true;
+}
+
+static void usage() {
+  std::cout <<
+    "sud-store-bench [--db <path>] [--functions N] [--calls N]\n"
+    "                [--legacy-rows N] [--batch N]\n"
+    "\n"
+    "  --legacy-rows  calls in the sample written by both modes (plus the\n"
+    "                 functions they reference), 0 = skip (default 2000;\n"
+    "                 legacy mode is fsync bound)\n";
+}
+
+// write-form model (SudModel is the id-keyed read form)
+struct SyntheticModel {
+  std::vector<SudFunction> functions;
+  std::vector<SudCall> calls;
+};
+
+static SyntheticModel makeModel(std::size_t nFuncs, std::size_t nCalls) {
+  SyntheticModel m;
+  m.functions.reserve(nFuncs);
+  for (std::size_t i = 0; i < nFuncs; ++i) {
+    std::string name = "Rte_Runnable_" + std::to_string(i);
+    m.functions.push_back(SudFunction{
+      "c:@F@" + name,
+      name,
+      "gen/file_" + std::to_string(i / 50) + ".c"
+    });
+  }
+
+  // deterministic LCG so runs are comparable across commits
+  std::uint64_t x = 0x9E3779B97F4A7C15ull;
+  auto next = [&]() {
+    x = x * 6364136223846793005ull + 1442695040888963407ull;
+    return (std::size_t)(x >> 33);
+  };
+
+  m.calls.reserve(nCalls);
+  for (std::size_t i = 0; i < nCalls; ++i) {
+    const auto& a = m.functions[next() % nFuncs];
+    const auto& b = m.functions[next() % nFuncs];
+    m.calls.push_back(SudCall{ a.usr, b.usr, a.name, b.name });
+  }
+  return m;
+}
+
+static void removeDb(const std::string& path) {
+  std::remove(path.c_str());
+  std::remove((path + "-wal").c_str());
+  std::remove((path + "-shm").c_str());
+  std::remove((path + "-journal").c_str());
+}
+
+// sample: the first nCalls calls + the functions they reference
+static SyntheticModel makeSample(const SyntheticModel& m, std::size_t nCalls) {
+  SyntheticModel s;
+  s.calls.assign(m.calls.begin(), m.calls.begin() + std::min(nCalls, m.calls.size()));
+  std::unordered_set<std::string> used;
+  for (const auto& c : s.calls) {
+    used.insert(c.callerUSR);
+    used.insert(c.calleeUSR);
+  }
+  for (const auto& f : m.functions) {
+    if (used.count(f.usr)) s.functions.push_back(f);
+  }
+  return s;
+}
+
+/* ------------------------------------------------------------
+ * Legacy write path (schema and inserts as before the
+ * transactional store): autocommit, so every row is a commit
+ * ------------------------------------------------------------ */
+static void legacyWrite(const std::string& path, const SyntheticModel& m) {
+  sqlite3* db = nullptr;
+  if (sqlite3_open(path.c_str(), &db) != SQLITE_OK) {
+    sqlite3_close(db);
+    throw std::runtime_error("Failed to open SQLite DB: " + path);
+  }
+
+  const char* schema = R"(
+    CREATE TABLE IF NOT EXISTS sud_function (
+      usr        TEXT PRIMARY KEY,
+      name       TEXT NOT NULL,
+      file       TEXT NOT NULL
+    );
+
+    CREATE TABLE IF NOT EXISTS sud_call (
+      caller_usr TEXT NOT NULL,
+      callee_usr TEXT NOT NULL,
+      FOREIGN KEY(caller_usr) REFERENCES sud_function(usr),
+      FOREIGN KEY(callee_usr) REFERENCES sud_function(usr)
+    );
+
+    CREATE INDEX IF NOT EXISTS idx_sud_call_caller
+      ON sud_call(caller_usr);
+
+    CREATE INDEX IF NOT EXISTS idx_sud_call_callee
+      ON sud_call(callee_usr);
+  )";
+  sqlite3_exec(db, schema, nullptr, nullptr, nullptr);
+
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(db,
+    "INSERT OR IGNORE INTO sud_function (usr, name, file) VALUES (?, ?, ?);",
+    -1, &stmt, nullptr);
+  for (const auto& f : m.functions) {
+    sqlite3_bind_text(stmt, 1, f.usr.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, f.name.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 3, f.file.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+  }
+  sqlite3_finalize(stmt);
+
+  sqlite3_prepare_v2(db,
+    "INSERT INTO sud_call (caller_usr, callee_usr) VALUES (?, ?);",
+    -1, &stmt, nullptr);
+  for (const auto& c : m.calls) {
+    sqlite3_bind_text(stmt, 1, c.callerUSR.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_text(stmt, 2, c.calleeUSR.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+  }
+  sqlite3_finalize(stmt);
+
+  sqlite3_close(db);
+}
+
+static double batchedWrite(const std::string& path, const SyntheticModel& m, std::size_t batch) {
+  removeDb(path);
+  SqliteStore store(path);
+  store.initSchema();
+  store.setBatchSize(batch);
+
+  auto t0 = std::chrono::steady_clock::now();
+  {
+    SqliteStore::IndexingSession session(store);
+    store.insertFunctions(m.functions);
+    store.insertCalls(m.calls);
+  }
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static void report(const char* mode, const SyntheticModel& m, double sec) {
+  const std::size_t rows = m.functions.size() + m.calls.size();
+  std::cout << std::left << std::setw(8) << mode
+            << " functions=" << std::setw(8) << m.functions.size()
+            << " calls=" << std::setw(9) << m.calls.size()
+            << " rows=" << std::setw(9) << rows
+            << " time=" << std::fixed << std::setprecision(3) << sec << "s"
+            << " rows/s=" << std::setprecision(0) << (sec > 0 ? rows / sec : 0.0)
+            << "\n" << std::defaultfloat;
+}
+
+int main(int argc, char** argv) {
+  std::string dbPath = "sud-store-bench.db";
+  std::size_t nFuncs = 10000;
+  std::size_t nCalls = 1000000;
+  std::size_t legacyRows = 2000;
+  std::size_t batch = 10000;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a == "--db" && i + 1 < argc) { dbPath = argv[++i]; continue; }
+    if (a == "--functions" && i + 1 < argc && parseCount(argv[i + 1], nFuncs)) { ++i; continue; }
+    if (a == "--calls" && i + 1 < argc && parseCount(argv[i + 1], nCalls)) { ++i; continue; }
+    if (a == "--legacy-rows" && i + 1 < argc && parseCount(argv[i + 1], legacyRows)) { ++i; continue; }
+    if (a == "--batch" && i + 1 < argc && parseCount(argv[i + 1], batch)) { ++i; continue; }
+    usage();
+    return (a == "--help" || a == "-h") ? 0 : 1;
+  }
+  if (nFuncs == 0) nFuncs = 1;
+
+  SyntheticModel model = makeModel(nFuncs, nCalls);
+
+  /* ---- same sample through both write paths ---- */
+  if (legacyRows > 0) {
+    const SyntheticModel sample = makeSample(model, legacyRows);
+    std::cout << "sample (same rows through both modes):\n";
+
+    removeDb(dbPath);
+    auto t0 = std::chrono::steady_clock::now();
+    legacyWrite(dbPath, sample);
+    report("legacy", sample, std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count());
+
+    report("batched", sample, batchedWrite(dbPath, sample, batch));
+  }
+
+  /* ---- whole model, batched only ---- */
+  std::cout << "full model (batched only, legacy is not run at this size):\n";
+  report("batched", model, batchedWrite(dbPath, model, batch));
+
+  removeDb(dbPath);
+  return 0;
+}
@@ -0,0 +1,160 @@
+#include "graph/PointsTo.h"
+#include "graph/Scc.h"
+#include "graph/SudGraph.h"
+#include "storage/SqliteStore.h"
+#include "profile/Profiler.h"
+
+#include <algorithm>
+#include <iterator>
+#include <string_view>
+#include <unordered_map>
+
+/* ============================================================
+ * Resolution
+ * ============================================================ */
+
+std::vector<SudCall> resolveIndirectCalls(const std::vector<SudPtrFact>& facts)
+{
+  ScopedTimer timer("graph.pointsto");
+
+  /* ---- cells / functions as dense ids ---- */
+  // the copy graph reuses the call graph machinery: one (unnamed) node
+  // per cell, an edge from the copied cell to the assigned one
+  SudModel flow;
+  std::unordered_map<std::string_view, std::uint32_t> cellIds;
+  cellIds.reserve(facts.size());
+  auto cellOf = [&](const std::string& key) {
+    auto [it, added] = cellIds.try_emplace(key, (std::uint32_t)flow.functions.size());
+    if (added) flow.functions.emplace_back();
+    return it->second;
+  };
+
+  std::unordered_map<std::string_view, std::uint32_t> functionIds;
+  std::vector<const SudPtrFact*> functions;   // first Address fact naming each
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> addresses;   // cell, function
+  std::vector<const SudPtrFact*> calls;
+
+  for (const auto& f : facts) {
+    switch (f.kind) {
+      case SudPtrFactKind::Address: {
+        auto [it, added] = functionIds.try_emplace(f.source, (std::uint32_t)functions.size());
+        if (added) functions.push_back(&f);
+        addresses.emplace_back(cellOf(f.cell), it->second);
+        break;
+      }
+      case SudPtrFactKind::Copy: {
+        const std::uint32_t from = cellOf(f.source);
+        flow.edges.push_back(SudEdge{ from, cellOf(f.cell) });
+        break;
+      }
+      case SudPtrFactKind::Call:
+        cellOf(f.cell);
+        calls.push_back(&f);
+        break;
+    }
+  }
+
+  const std::size_t cells = flow.functions.size();
+  const SudGraph g(std::move(flow));
+  const SccResult scc = computeScc(g);
+  const std::size_t n = scc.count();
+
+  /* ---- per component: own addresses + member cells ---- */
+  for (auto& a : addresses) a.first = scc.component[a.first];
+  std::sort(addresses.begin(), addresses.end());
+  addresses.erase(std::unique(addresses.begin(), addresses.end()), addresses.end());
+
+  std::vector<std::uint32_t> offsets(n + 1, 0);
+  for (std::size_t v = 0; v < cells; ++v) ++offsets[scc.component[v] + 1];
+  for (std::size_t c = 0; c < n; ++c) offsets[c + 1] += offsets[c];
+  std::vector<SudGraph::NodeId> members(cells);
+  {
+    std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (SudGraph::NodeId v = 0; v < cells; ++v) members[cursor[scc.component[v]]++] = v;
+  }
+
+  /* ---- sets, sources first ---- */
+  // copies go from higher to lower component ids; a component without
+  // own addresses fed by one set only points at that set
+  constexpr std::uint32_t kNoSet = UINT32_MAX;
+  std::vector<std::vector<std::uint32_t>> sets;
+  std::vector<std::uint32_t> setOf(n, kNoSet);
+  std::vector<std::uint32_t> inputs;
+  auto ownEnd = addresses.end();   // c's own addresses end here (sorted by component)
+
+  for (std::uint32_t c = (std::uint32_t)n; c-- > 0;) {
+    inputs.clear();
+    for (std::uint32_t k = offsets[c]; k < offsets[c + 1]; ++k)
+      for (SudGraph::NodeId w : g.callers(members[k])) {
+        const std::uint32_t from = setOf[scc.component[w]];
+        if (from != kNoSet) inputs.push_back(from);
+      }
+    std::sort(inputs.begin(), inputs.end());
+    inputs.erase(std::unique(inputs.begin(), inputs.end()), inputs.end());
+
+    auto own = ownEnd;
+    while (own != addresses.begin() && std::prev(own)->first == c) --own;
+
+    if (own == ownEnd && inputs.size() <= 1) {
+      if (!inputs.empty()) setOf[c] = inputs[0];
+      continue;
+    }
+
+    std::vector<std::uint32_t> merged;
+    for (auto it = own; it != ownEnd; ++it) merged.push_back(it->second);
+    ownEnd = own;
+    for (std::uint32_t s : inputs) merged.insert(merged.end(), sets[s].begin(), sets[s].end());
+    std::sort(merged.begin(), merged.end());
+    merged.erase(std::unique(merged.begin(), merged.end()), merged.end());
+    setOf[c] = (std::uint32_t)sets.size();
+    sets.push_back(std::move(merged));
+  }
+
+  /* ---- call sites -> candidate targets ---- */
+  // facts of one call site (c ? fp : gp)() are adjacent, same caller / seq
+  std::vector<SudCall> out;
+  std::vector<std::uint32_t> targets;
+  std::size_t unresolved = 0;
+
+  for (std::size_t i = 0; i < calls.size();) {
+    const SudPtrFact& site = *calls[i];
+    targets.clear();
+    for (; i < calls.size() && calls[i]->seq == site.seq && calls[i]->source == site.source; ++i) {
+      const std::uint32_t s = setOf[scc.component[cellIds.at(calls[i]->cell)]];
+      if (s != kNoSet) targets.insert(targets.end(), sets[s].begin(), sets[s].end());
+    }
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+    if (targets.empty()) ++unresolved;
+
+    for (std::uint32_t t : targets) {
+      SudCall call;
+      call.callerUSR = site.source;
+      call.callerName = site.name;
+      call.calleeUSR = functions[t]->source;
+      call.calleeName = functions[t]->name;
+      call.line = site.line;
+      call.seq = site.seq;
+      call.kind = SudCallKind::Indirect;
+      out.push_back(std::move(call));
+    }
+  }
+
+  Profiler& prof = Profiler::instance();
+  prof.count("ptr.cells", (std::int64_t)cells);
+  prof.count("ptr.sets", (std::int64_t)sets.size());
+  prof.count("ptr.indirect", (std::int64_t)out.size());
+  prof.count("ptr.unresolved", (std::int64_t)unresolved);
+  return out;
+}
+
+/* ============================================================
+ * DB refresh
+ * ============================================================ */
+
+std::size_t refreshIndirectCalls(SqliteStore& db)
+{
+  const std::vector<SudCall> calls = resolveIndirectCalls(db.loadPointerFacts());
+  db.replaceIndirectCalls(calls);
+  return calls.size();
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "ir/sud/SudModel.h"
+
+class SqliteStore;
+
+/*
+ * ============================================================
+ * Function pointer points-to (flow / context insensitive)
+ * - cells (variables, struct fields, arrays, parameters, return
+ *   values) hold sets of function addresses; Copy facts are
+ *   inclusion edges between cells
+ * - copy cycles are collapsed (computeScc), then sets flow once
+ *   through the condensation in topological order; a cell fed by
+ *   a single other cell shares its set instead of copying it
+ * - every Call fact yields one Indirect edge per candidate target,
+ *   at the call site's line / seq
+ * ============================================================
+ */
+std::vector<SudCall> resolveIndirectCalls(const std::vector<SudPtrFact>& facts);
+
+/*
+ * Re-resolves the DB's indirect calls from every file's facts
+ * (replaceIndirectCalls); returns the number of edges written.
+ */
+std::size_t refreshIndirectCalls(SqliteStore& db);
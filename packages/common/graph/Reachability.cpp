@@ -0,0 +1,164 @@
+#include "graph/Reachability.h"
+#include "graph/Scc.h"
+#include "graph/SudGraph.h"
+#include "storage/SqliteStore.h"
+#include "profile/Profiler.h"
+
+#include <algorithm>
+#include <functional>
+
+/* ============================================================
+ * Interval labelling
+ * ============================================================ */
+
+SudReachIndex buildReachIndex(const SudCondensation& c, std::size_t maxIntervals)
+{
+  ScopedTimer timer("graph.reach");
+  maxIntervals = std::max<std::size_t>(maxIntervals, 1);
+  const std::size_t n = c.components.size();
+
+  // reversed DAG (callee -> callers); every edge goes to a higher id
+  std::vector<std::uint32_t> offsets(n + 1, 0);
+  for (const auto& e : c.edges) ++offsets[e.callee + 1];
+  for (std::size_t i = 0; i < n; ++i) offsets[i + 1] += offsets[i];
+  std::vector<std::uint32_t> callers(c.edges.size());
+  {
+    std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (const auto& e : c.edges) callers[cursor[e.callee]++] = e.caller;
+  }
+
+  /* ---- spanning forest: post-order + subtree interval ---- */
+  // ascending id is a topological order of the reversed DAG, so every
+  // DFS started from an unvisited component begins at a source
+  constexpr std::uint32_t kUnvisited = UINT32_MAX;
+  SudReachIndex out;
+  out.post.assign(n, kUnvisited);
+  std::vector<std::uint32_t> first(n, 0);   // lowest post number in the subtree
+
+  struct Frame {
+    std::uint32_t node;
+    std::uint32_t next;
+  };
+  std::vector<Frame> frames;
+  std::vector<std::uint8_t> visited(n, 0);
+  std::uint32_t counter = 0;
+
+  for (std::uint32_t root = 0; root < n; ++root) {
+    if (visited[root]) continue;
+    visited[root] = 1;
+    first[root] = counter;
+    frames.push_back(Frame{ root, offsets[root] });
+
+    while (!frames.empty()) {
+      Frame& f = frames.back();
+      if (f.next < offsets[f.node + 1]) {
+        const std::uint32_t w = callers[f.next++];
+        if (!visited[w]) {
+          visited[w] = 1;
+          first[w] = counter;
+          frames.push_back(Frame{ w, offsets[w] });   // invalidates f
+        }
+        continue;
+      }
+      out.post[f.node] = counter++;
+      frames.pop_back();
+    }
+  }
+
+  /* ---- labels: own subtree + every caller's label, merged ---- */
+  // callers have higher ids: descending id sees them finished
+  std::vector<std::vector<SudInterval>> labels(n);
+  std::vector<SudInterval> merged;
+  std::vector<std::uint32_t> gaps;
+  std::size_t approximate = 0;
+
+  for (std::uint32_t v = (std::uint32_t)n; v-- > 0;) {
+    merged.clear();
+    merged.push_back(SudInterval{ first[v], out.post[v] });
+    for (std::uint32_t k = offsets[v]; k < offsets[v + 1]; ++k) {
+      const auto& l = labels[callers[k]];
+      merged.insert(merged.end(), l.begin(), l.end());
+    }
+    std::sort(merged.begin(), merged.end(), [](const SudInterval& a, const SudInterval& b) {
+      return a.lo < b.lo;
+    });
+
+    auto& label = labels[v];
+    for (const auto& iv : merged) {
+      if (!label.empty() && iv.lo <= label.back().hi + 1) {
+        label.back().hi = std::max(label.back().hi, iv.hi);
+        label.back().exact = label.back().exact && iv.exact;
+      } else {
+        label.push_back(iv);
+      }
+    }
+
+    // over the cap: split at the widest gaps only, fuse across the rest
+    if (label.size() > maxIntervals) {
+      const std::size_t splits = maxIntervals - 1;
+      gaps.clear();
+      for (std::size_t i = 0; i + 1 < label.size(); ++i) gaps.push_back(label[i + 1].lo - label[i].hi);
+
+      std::uint32_t threshold = UINT32_MAX;
+      std::size_t ties = 0;   // gaps equal to the threshold that still split
+      if (splits > 0) {
+        std::nth_element(gaps.begin(), gaps.begin() + (splits - 1), gaps.end(), std::greater<>());
+        threshold = gaps[splits - 1];
+        ties = splits - (std::size_t)std::count_if(gaps.begin(), gaps.begin() + splits,
+                                                   [&](std::uint32_t g) { return g > threshold; });
+      }
+
+      std::size_t w = 0;
+      for (std::size_t i = 1; i < label.size(); ++i) {
+        const std::uint32_t gap = label[i].lo - label[w].hi;
+        if (gap > threshold || (gap == threshold && ties > 0 && ties--)) {
+          label[++w] = label[i];
+        } else {
+          label[w].hi = label[i].hi;
+          label[w].exact = false;
+        }
+      }
+      label.resize(w + 1);
+      ++approximate;
+    }
+    label.shrink_to_fit();
+  }
+
+  out.offsets.assign(n + 1, 0);
+  for (std::size_t v = 0; v < n; ++v) out.offsets[v + 1] = out.offsets[v] + (std::uint32_t)labels[v].size();
+  out.intervals.reserve(out.offsets[n]);
+  for (auto& l : labels) {
+    out.intervals.insert(out.intervals.end(), l.begin(), l.end());
+    std::vector<SudInterval>().swap(l);
+  }
+
+  Profiler::instance().count("reach.intervals", (std::int64_t)out.intervals.size());
+  Profiler::instance().count("reach.capped", (std::int64_t)approximate);
+  return out;
+}
+
+/* ============================================================
+ * DB refresh
+ * ============================================================ */
+
+bool refreshReachIndex(SqliteStore& db, bool force, std::size_t maxIntervals)
+{
+  if (!force && db.reachGeneration() == db.generation()) return false;
+
+  SudCondensation cond;
+  if (force || !db.loadCondensation(cond)) {
+    SudGraph g(db.loadSudModel());
+    cond = condense(g, computeScc(g));
+
+    // same components and component edges as the stored index (body
+    // edits, calls inside a cycle, repeated calls): nothing to rewrite
+    if (!force && db.reachGeneration() >= 0 && cond.fingerprint == db.condensationFingerprint()) {
+      db.restampReachIndex();
+      Profiler::instance().count("reach.restamped");
+      return false;
+    }
+    db.saveCondensation(cond);
+  }
+  db.saveReachIndex(buildReachIndex(cond, maxIntervals));
+  return true;
+}
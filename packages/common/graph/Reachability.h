@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstddef>
+
+#include "ir/sud/SudModel.h"
+
+class SqliteStore;
+
+/*
+ * ============================================================
+ * Reachability index over the SCC condensation
+ * - tree-cover interval labelling (Agrawal et al.) of the
+ *   reversed DAG: one DFS post-order + merged interval lists
+ * - labels capped at maxIntervals per component (Ferrari style):
+ *   beyond the cap the closest intervals are fused and flagged
+ *   approximate, so the index stays O(components * cap) on
+ *   dense graphs where exact labels grow quadratically
+ * - exact hit / no hit answers a query outright; only an
+ *   approximate hit needs a (label pruned) look at the callers
+ * ============================================================
+ */
+constexpr std::size_t kReachMaxIntervals = 64;
+
+SudReachIndex buildReachIndex(const SudCondensation& c,
+                              std::size_t maxIntervals = kReachMaxIntervals);
+
+/*
+ * Brings the DB's condensation (sud_scc*) and reachability index
+ * (sud_reach*) up to the current graph generation.
+ * - nothing is recomputed while both are current (unless force)
+ * - a stale index whose condensation comes out the same (compared
+ *   by fingerprint) is restamped in place instead of rewritten
+ * - returns true if the index was rebuilt
+ */
+bool refreshReachIndex(SqliteStore& db, bool force = false,
+                       std::size_t maxIntervals = kReachMaxIntervals);
@@ -0,0 +1,152 @@
+#include "graph/Scc.h"
+#include "profile/Profiler.h"
+
+#include <algorithm>
+
+/* ============================================================
+ * Iterative Tarjan
+ * ============================================================ */
+
+SccResult computeScc(const SudGraph& g)
+{
+  ScopedTimer timer("graph.scc");
+  using NodeId = SudGraph::NodeId;
+
+  const std::size_t n = g.nodeCount();
+  constexpr std::uint32_t kUnvisited = UINT32_MAX;
+
+  SccResult out;
+  out.component.assign(n, kUnvisited);
+
+  std::vector<std::uint32_t> index(n, kUnvisited);
+  std::vector<std::uint32_t> low(n, 0);
+  std::vector<std::uint8_t> onStack(n, 0);
+  std::vector<std::uint8_t> selfCall(n, 0);
+  std::vector<NodeId> stack;   // Tarjan's node stack
+
+  // DFS frame: node + position in its callee list
+  struct Frame {
+    NodeId node;
+    std::uint32_t next;
+  };
+  std::vector<Frame> frames;
+  std::uint32_t counter = 0;
+
+  auto visit = [&](NodeId v) {
+    index[v] = low[v] = counter++;
+    stack.push_back(v);
+    onStack[v] = 1;
+    frames.push_back(Frame{ v, 0 });
+  };
+
+  for (NodeId root = 0; root < n; ++root) {
+    if (index[root] != kUnvisited) continue;
+    visit(root);
+
+    while (!frames.empty()) {
+      Frame& f = frames.back();
+      const NodeId v = f.node;
+      const SudGraph::Range callees = g.callees(v);
+
+      if (f.next < callees.size()) {
+        const NodeId w = callees.first[f.next++];
+        if (w == v) selfCall[v] = 1;
+
+        if (index[w] == kUnvisited) {
+          visit(w);   // invalidates f
+        } else if (onStack[w]) {
+          low[v] = std::min(low[v], index[w]);
+        }
+        continue;
+      }
+
+      // all callees done: v closes a component if it is its root
+      frames.pop_back();
+      if (low[v] == index[v]) {
+        const auto comp = (std::uint32_t)out.components.size();
+        SudComponent c;
+        NodeId w;
+        do {
+          w = stack.back();
+          stack.pop_back();
+          onStack[w] = 0;
+          out.component[w] = comp;
+          ++c.size;
+        } while (w != v);
+        c.recursive = c.size > 1 || selfCall[v];
+        out.components.push_back(c);
+      }
+      if (!frames.empty()) {
+        const NodeId u = frames.back().node;
+        low[u] = std::min(low[u], low[v]);
+      }
+    }
+  }
+
+  return out;
+}
+
+/* ============================================================
+ * Condensation (DB form)
+ * ============================================================ */
+
+static std::uint64_t mix(std::uint64_t x)
+{
+  // splitmix64 finaliser
+  x += 0x9E3779B97F4A7C15ull;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+  return x ^ (x >> 31);
+}
+
+// order independent: sums over functions and over (unique) edges
+static std::int64_t fingerprint(const SudCondensation& c)
+{
+  std::vector<std::int64_t> rep(c.components.size(), INT64_MAX);
+  for (std::size_t i = 0; i < c.functionIds.size(); ++i) {
+    std::int64_t& r = rep[c.component[i]];
+    if (c.functionIds[i] < r) r = c.functionIds[i];
+  }
+
+  std::uint64_t h = mix(c.functionIds.size()) ^ mix(c.edges.size() + 0x100000000ull);
+  for (std::size_t i = 0; i < c.functionIds.size(); ++i) {
+    const std::uint32_t k = c.component[i];
+    h += mix(mix((std::uint64_t)c.functionIds[i]) ^ ((std::uint64_t)rep[k] << 1 | c.components[k].recursive));
+  }
+  for (const auto& e : c.edges) {
+    h += mix(mix((std::uint64_t)rep[e.caller] + 1) ^ (std::uint64_t)rep[e.callee]);
+  }
+  return (std::int64_t)(h & (std::uint64_t)INT64_MAX);
+}
+
+SudCondensation condense(const SudGraph& g, const SccResult& scc)
+{
+  ScopedTimer timer("graph.condense");
+  SudCondensation out;
+
+  const std::size_t n = g.nodeCount();
+  out.functionIds.reserve(n);
+  out.component.reserve(n);
+  for (SudGraph::NodeId v = 0; v < n; ++v) {
+    out.functionIds.push_back(g.node(v).id);
+    out.component.push_back(scc.component[v]);
+  }
+  out.components = scc.components;
+
+  for (SudGraph::NodeId v = 0; v < n; ++v) {
+    const std::uint32_t from = scc.component[v];
+    for (SudGraph::NodeId w : g.callees(v)) {
+      if (scc.component[w] != from) out.edges.push_back(SudEdge{ from, scc.component[w] });
+    }
+  }
+
+  std::sort(out.edges.begin(), out.edges.end(), [](const SudEdge& a, const SudEdge& b) {
+    return a.caller != b.caller ? a.caller < b.caller : a.callee < b.callee;
+  });
+  out.edges.erase(std::unique(out.edges.begin(), out.edges.end(), [](const SudEdge& a, const SudEdge& b) {
+    return a.caller == b.caller && a.callee == b.callee;
+  }), out.edges.end());
+
+  out.fingerprint = fingerprint(out);
+  return out;
+}
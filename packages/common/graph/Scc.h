@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "graph/SudGraph.h"
+#include "ir/sud/SudModel.h"
+
+/*
+ * ============================================================
+ * Strongly connected components of the call graph
+ * - iterative Tarjan, O(V + E), explicit frame stack (no native
+ *   recursion, safe on arbitrarily deep call chains)
+ * - component ids in completion order: a call between two
+ *   components always goes from the higher to the lower id
+ * ============================================================
+ */
+struct SccResult {
+  std::vector<std::uint32_t> component;   // per node
+  std::vector<SudComponent> components;   // per component
+
+  std::size_t count() const { return components.size(); }
+};
+
+SccResult computeScc(const SudGraph& g);
+
+// DB form: per-function component (by sud_function.id) + unique DAG edges.
+// The fingerprint names each component by its lowest function id, so two
+// condensations of the same components and component edges match even
+// when Tarjan numbered them differently.
+SudCondensation condense(const SudGraph& g, const SccResult& scc);
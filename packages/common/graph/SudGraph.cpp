@@ -0,0 +1,84 @@
+#include "graph/SudGraph.h"
+#include "profile/Profiler.h"
+
+#include <utility>
+
+/* ============================================================
+ * Build (counting sort into CSR)
+ * ============================================================ */
+
+static void buildCsr(std::size_t n,
+                     const std::vector<SudEdge>& edges,
+                     bool reverse,
+                     std::vector<std::uint32_t>& offsets,
+                     std::vector<SudGraph::NodeId>& targets)
+{
+  offsets.assign(n + 1, 0);
+  for (const auto& e : edges) {
+    ++offsets[(reverse ? e.callee : e.caller) + 1];
+  }
+  for (std::size_t i = 0; i < n; ++i) {
+    offsets[i + 1] += offsets[i];
+  }
+
+  // stable: edges keep their model (call-site) order per node
+  targets.resize(edges.size());
+  std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+  for (const auto& e : edges) {
+    const auto from = reverse ? e.callee : e.caller;
+    const auto to = reverse ? e.caller : e.callee;
+    targets[cursor[from]++] = to;
+  }
+}
+
+SudGraph::SudGraph(SudModel model)
+  : model_(std::move(model))
+{
+  ScopedTimer timer("graph.build");
+  const std::size_t n = model_.functions.size();
+
+  buildCsr(n, model_.edges, /*reverse*/false, fwdOffsets_, fwdTargets_);
+  buildCsr(n, model_.edges, /*reverse*/true, revOffsets_, revTargets_);
+
+  byUsr_.reserve(n);
+  byName_.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const auto& f = model_.functions[i];
+    byUsr_.emplace(f.usr, (NodeId)i);
+    byName_.emplace(f.name, (NodeId)i);   // keeps the first (lowest id)
+  }
+}
+
+/* ============================================================
+ * Lookup / adjacency
+ * ============================================================ */
+
+SudGraph::NodeId SudGraph::findByUsr(std::string_view usr) const
+{
+  auto it = byUsr_.find(usr);
+  return it == byUsr_.end() ? kNone : it->second;
+}
+
+SudGraph::NodeId SudGraph::findByName(std::string_view name) const
+{
+  auto it = byName_.find(name);
+  return it == byName_.end() ? kNone : it->second;
+}
+
+SudGraph::NodeId SudGraph::resolve(std::string_view usrOrName) const
+{
+  NodeId id = findByUsr(usrOrName);
+  return id != kNone ? id : findByName(usrOrName);
+}
+
+SudGraph::Range SudGraph::callees(NodeId id) const
+{
+  const NodeId* base = fwdTargets_.data();
+  return Range{ base + fwdOffsets_[id], base + fwdOffsets_[id + 1] };
+}
+
+SudGraph::Range SudGraph::callers(NodeId id) const
+{
+  const NodeId* base = revTargets_.data();
+  return Range{ base + revOffsets_[id], base + revOffsets_[id + 1] };
+}
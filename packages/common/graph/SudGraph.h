@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ir/sud/SudModel.h"
+
+/*
+ * ============================================================
+ * In-memory call graph (built once from a SudModel)
+ * - dense node ids = indices into SudModel::functions
+ * - forward / reverse CSR adjacency (call-site order kept)
+ * - USR / name -> node id hash index
+ * ============================================================
+ */
+class SudGraph {
+public:
+  using NodeId = std::uint32_t;
+  static constexpr NodeId kNone = UINT32_MAX;
+
+  /* contiguous neighbour list */
+  struct Range {
+    const NodeId* first;
+    const NodeId* last;
+
+    const NodeId* begin() const { return first; }
+    const NodeId* end() const { return last; }
+    std::size_t size() const { return (std::size_t)(last - first); }
+    bool empty() const { return first == last; }
+  };
+
+  explicit SudGraph(SudModel model);
+
+  // index keys point into model_; copying would leave them dangling
+  SudGraph(const SudGraph&) = delete;
+  SudGraph& operator=(const SudGraph&) = delete;
+  SudGraph(SudGraph&&) = default;
+  SudGraph& operator=(SudGraph&&) = default;
+
+  std::size_t nodeCount() const { return model_.functions.size(); }
+  std::size_t edgeCount() const { return fwdTargets_.size(); }
+
+  const SudFunction& node(NodeId id) const { return model_.functions[id]; }
+  const SudModel& model() const { return model_; }
+
+  /* O(1) lookups (kNone if absent) */
+  NodeId findByUsr(std::string_view usr) const;
+  NodeId findByName(std::string_view name) const;   // lowest id with that name
+  NodeId resolve(std::string_view usrOrName) const; // USR first, then name
+
+  /* adjacency */
+  Range callees(NodeId id) const;
+  Range callers(NodeId id) const;
+
+private:
+  SudModel model_;
+
+  std::vector<std::uint32_t> fwdOffsets_;   // nodeCount + 1
+  std::vector<NodeId> fwdTargets_;
+  std::vector<std::uint32_t> revOffsets_;
+  std::vector<NodeId> revTargets_;
+
+  std::unordered_map<std::string_view, NodeId> byUsr_;
+  std::unordered_map<std::string_view, NodeId> byName_;
+};
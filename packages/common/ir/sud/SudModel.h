@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -11,21 +12,105 @@
  * ============================================================
  */
 
+/* -------------------- Indexed source file -------------------- */
+struct SudFileDep {
+  std::string path;    // normalized absolute path of an included header
+  std::string hash;    // its content hash when the file was indexed
+};
+
+struct SudFile {
+  std::string path;    // normalized absolute path
+  std::string hash;    // content (+ compile flags) hash
+  std::vector<SudFileDep> deps;   // headers the last parse read
+};
+
 /* -------------------- Function -------------------- */
 struct SudFunction {
   std::string usr;     // clang USR (unique id)
   std::string name;    // function name
-  std::string file;    // source file path
+  std::string file;    // source file path ("" = referenced only, not defined in an indexed file)
+  std::int64_t id = 0; // sud_function.id (filled on load)
 };
 
-/* -------------------- Call -------------------- */
+/* -------------------- Call (write form, USR keyed) -------------------- */
+// sud_call.kind: Indirect = a candidate target of a call through a
+// function pointer, resolved by the points-to pass (graph/PointsTo.h)
+enum class SudCallKind : int { Direct = 0, Indirect = 1 };
+
 struct SudCall {
   std::string callerUSR;
   std::string calleeUSR;
+  std::string callerName;  // name for a USR not stored as a function yet
+  std::string calleeName;
+  int line = 0;            // call-site line (0 = unknown)
+  int seq = 0;             // call-site order within the caller's body
+  SudCallKind kind = SudCallKind::Direct;
+};
+
+/* -------------------- Function pointer fact (write form, per file) -------------------- */
+// input of the points-to pass. A cell is an abstract location that can
+// hold function addresses, keyed by text:
+//   variable / array (all elements)   its USR
+//   struct field (all instances)      the field's USR
+//   parameter i / return value        "<function USR>#<i>" / "<function USR>#ret"
+enum class SudPtrFactKind : int {
+  Address = 0,   // cell <- &function        (source = function USR)
+  Copy = 1,      // cell <- every target of another cell (source = that cell)
+  Call = 2       // call through cell         (source = caller USR)
+};
+
+struct SudPtrFact {
+  SudPtrFactKind kind = SudPtrFactKind::Address;
+  std::string cell;
+  std::string source;
+  std::string name;        // Address / Call: function name for a USR not stored yet
+  int line = 0;            // Call: call-site line
+  int seq = 0;             // Call: call-site order within the caller's body
+};
+
+/* -------------------- Edge (read form, id keyed) -------------------- */
+// caller / callee are indices into SudModel::functions
+struct SudEdge {
+  std::uint32_t caller;
+  std::uint32_t callee;
+  std::uint32_t line = 0;   // call-site line (loadSudModel only, 0 = unknown)
 };
 
 /* -------------------- Whole Model -------------------- */
 struct SudModel {
   std::vector<SudFunction> functions;
-  std::vector<SudCall> calls;
+  std::vector<SudEdge> edges;
+};
+
+/* -------------------- SCC condensation (cached in the DB) -------------------- */
+// components are numbered in completion order: every DAG edge goes from a
+// higher to a lower component id (callees first)
+struct SudComponent {
+  std::uint32_t size = 0;
+  bool recursive = false;    // more than one function, or a function calling itself
+};
+
+struct SudCondensation {
+  std::vector<std::int64_t> functionIds;    // sud_function.id
+  std::vector<std::uint32_t> component;     // component of functionIds[i]
+  std::vector<SudComponent> components;
+  std::vector<SudEdge> edges;               // caller component -> callee component, unique
+  std::int64_t fingerprint = -1;            // independent of component numbering, -1 = unknown
+};
+
+/* -------------------- Reachability index (cached in the DB) -------------------- */
+// interval labelling of the reversed condensation (callee -> caller):
+// every component calling c, directly or transitively, has its post-order
+// number inside one of c's intervals. An exact interval holds callers only;
+// an approximate one (label size capped) may also hold non-callers.
+struct SudInterval {
+  std::uint32_t lo;
+  std::uint32_t hi;          // inclusive
+  bool exact = true;
+};
+
+struct SudReachIndex {
+  std::vector<std::uint32_t> post;       // per component
+  std::vector<std::uint32_t> offsets;    // components + 1: intervals of c = [offsets[c], offsets[c + 1])
+  std::vector<SudInterval> intervals;    // sorted and disjoint per component
 };
@@ -0,0 +1,267 @@
+#include "profile/Profiler.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#  include <psapi.h>
+#else
+#  include <sys/resource.h>
+#  include <unistd.h>
+#endif
+
+/* ============================================================
+ * Process memory
+ * ============================================================ */
+
+std::size_t peakRssBytes()
+{
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    return (std::size_t)pmc.PeakWorkingSetSize;
+  return 0;
+#else
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+#  if defined(__APPLE__)
+  return (std::size_t)ru.ru_maxrss;          // bytes
+#  else
+  return (std::size_t)ru.ru_maxrss * 1024;   // KiB
+#  endif
+#endif
+}
+
+std::size_t currentRssBytes()
+{
+#if defined(_WIN32)
+  PROCESS_MEMORY_COUNTERS pmc;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+    return (std::size_t)pmc.WorkingSetSize;
+  return 0;
+#elif defined(__linux__)
+  FILE* f = std::fopen("/proc/self/statm", "r");
+  if (!f) return 0;
+  long pages = 0, resident = 0;
+  int n = std::fscanf(f, "%ld %ld", &pages, &resident);
+  std::fclose(f);
+  return n == 2 ? (std::size_t)resident * (std::size_t)sysconf(_SC_PAGESIZE) : 0;
+#else
+  return 0;
+#endif
+}
+
+/* ============================================================
+ * Helpers
+ * ============================================================ */
+
+namespace {
+
+void writeJsonString(std::ostream& os, const std::string& s)
+{
+  os << '"';
+  for (char c : s) {
+    switch (c) {
+      case '"':  os << "\\\""; break;
+      case '\\': os << "\\\\"; break;
+      case '\n': os << "\\n"; break;
+      case '\t': os << "\\t"; break;
+      default:
+        if ((unsigned char)c < 0x20) {
+          char buf[8];
+          std::snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)c);
+          os << buf;
+        } else {
+          os << c;
+        }
+    }
+  }
+  os << '"';
+}
+
+std::int64_t toUs(std::chrono::steady_clock::duration d)
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+}
+
+} // namespace
+
+/* ============================================================
+ * Profiler
+ * ============================================================ */
+
+Profiler& Profiler::instance()
+{
+  static Profiler p;
+  return p;
+}
+
+Profiler::Profiler()
+  : t0_(std::chrono::steady_clock::now())
+{
+}
+
+void Profiler::enable(bool trace)
+{
+  if (trace) tracing_.store(true, std::memory_order_relaxed);
+  enabled_.store(true, std::memory_order_relaxed);
+}
+
+std::uint32_t Profiler::threadIndex()
+{
+  auto ins = tids_.emplace(std::this_thread::get_id(), (std::uint32_t)tids_.size());
+  return ins.first->second;
+}
+
+void Profiler::addPhase(const char* phase, std::chrono::steady_clock::time_point start,
+                        std::chrono::steady_clock::time_point end)
+{
+  const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+  const bool trace = tracing();
+  const std::size_t rss = trace ? currentRssBytes() : 0;
+
+  std::lock_guard<std::mutex> lk(mu_);
+  Phase& p = phases_[phase];
+  ++p.count;
+  p.totalMs += ms;
+  if (ms > p.maxMs) p.maxMs = ms;
+
+  if (trace) {
+    events_.push_back(Event{ phase, toUs(start - t0_), toUs(end - start), threadIndex(), rss });
+  }
+}
+
+void Profiler::count(const char* name, std::int64_t n)
+{
+  if (!enabled()) return;
+  std::lock_guard<std::mutex> lk(mu_);
+  counters_[name] += n;
+}
+
+/* ---- reports ---- */
+
+void Profiler::writeStatsJson(std::ostream& os) const
+{
+  std::lock_guard<std::mutex> lk(mu_);
+  const double wallMs = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - t0_).count();
+
+  os << std::fixed << std::setprecision(3);
+  os << "{\"wallMs\":" << wallMs << ",\"peakRssBytes\":" << peakRssBytes();
+
+  os << ",\"phases\":{";
+  bool first = true;
+  for (const auto& kv : phases_) {
+    if (!first) os << ',';
+    first = false;
+    writeJsonString(os, kv.first);
+    os << ":{\"count\":" << kv.second.count
+       << ",\"totalMs\":" << kv.second.totalMs
+       << ",\"maxMs\":" << kv.second.maxMs << '}';
+  }
+
+  os << "},\"counters\":{";
+  first = true;
+  for (const auto& kv : counters_) {
+    if (!first) os << ',';
+    first = false;
+    writeJsonString(os, kv.first);
+    os << ':' << kv.second;
+  }
+  os << "}}\n" << std::defaultfloat;
+}
+
+void Profiler::writeStatsText(std::ostream& os) const
+{
+  std::lock_guard<std::mutex> lk(mu_);
+  const double wallMs = std::chrono::duration<double, std::milli>(
+    std::chrono::steady_clock::now() - t0_).count();
+
+  os << std::fixed << std::setprecision(1);
+  os << "---- stats: wall=" << wallMs << "ms, peak rss="
+     << (double)peakRssBytes() / (1024.0 * 1024.0) << "MiB ----\n";
+  for (const auto& kv : phases_) {
+    os << "  " << std::left << std::setw(18) << kv.first << std::right
+       << " n=" << std::setw(7) << kv.second.count
+       << "  total=" << std::setw(10) << kv.second.totalMs << "ms"
+       << "  max=" << std::setw(9) << kv.second.maxMs << "ms\n";
+  }
+  for (const auto& kv : counters_) {
+    os << "  " << std::left << std::setw(18) << kv.first << std::right
+       << " " << kv.second << "\n";
+  }
+  os << std::defaultfloat;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path) const
+{
+  std::ofstream os(path, std::ios::binary);
+  if (!os) return false;
+
+  std::lock_guard<std::mutex> lk(mu_);
+  os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+  bool first = true;
+  for (const auto& e : events_) {
+    if (!first) os << ",\n";
+    first = false;
+    os << "{\"name\":";
+    writeJsonString(os, e.name);
+    os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.tid
+       << ",\"ts\":" << e.startUs << ",\"dur\":" << e.durUs << '}';
+
+    // memory track next to the phases
+    if (e.rssBytes) {
+      os << ",\n{\"name\":\"rss\",\"ph\":\"C\",\"pid\":1,\"ts\":" << (e.startUs + e.durUs)
+         << ",\"args\":{\"MiB\":" << (double)e.rssBytes / (1024.0 * 1024.0) << "}}";
+    }
+  }
+  os << "]}\n";
+  return (bool)os;
+}
+
+/* ---- CLI glue ---- */
+
+bool Profiler::parseArg(int argc, const char* const* argv, int& i)
+{
+  const std::string a = argv[i];
+
+  if (a == "--stats" || a == "--stats=text") {
+    statsFormat_ = "text";
+    enable(false);
+    return true;
+  }
+  if (a == "--stats=json") {
+    statsFormat_ = "json";
+    enable(false);
+    return true;
+  }
+  if (a.rfind("--trace=", 0) == 0) {
+    tracePath_ = a.substr(8);
+    enable(true);
+    return true;
+  }
+  if (a == "--trace" && i + 1 < argc) {
+    tracePath_ = argv[++i];
+    enable(true);
+    return true;
+  }
+  return false;
+}
+
+void Profiler::report() const
+{
+  if (statsFormat_ == "json") {
+    writeStatsJson(std::cerr);
+  } else if (statsFormat_ == "text") {
+    writeStatsText(std::cerr);
+  }
+
+  if (!tracePath_.empty() && !writeChromeTrace(tracePath_)) {
+    std::cerr << "[stats] cannot write trace: " << tracePath_ << "\n";
+  }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * ============================================================
+ * Pipeline profiler (process-wide, off by default)
+ * - ScopedTimer: per-phase count / total / max (+ trace event)
+ * - counters: named int64 accumulators
+ * - peak / current RSS of the process
+ * - report: text or JSON breakdown, Chrome trace-event JSON
+ *   (chrome://tracing, Perfetto) with one track per thread
+ * Disabled, a ScopedTimer is one relaxed atomic load.
+ * ============================================================
+ */
+class Profiler {
+public:
+  static Profiler& instance();
+
+  // stats: aggregate phases/counters; trace: also keep every event
+  void enable(bool trace = false);
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  bool tracing() const { return tracing_.load(std::memory_order_relaxed); }
+
+  void addPhase(const char* phase, std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end);
+  void count(const char* name, std::int64_t n = 1);
+
+  // {"wallMs":..,"peakRssBytes":..,"phases":{..},"counters":{..}}
+  void writeStatsJson(std::ostream& os) const;
+  void writeStatsText(std::ostream& os) const;
+  bool writeChromeTrace(const std::string& path) const;
+
+  // --stats[=json|text] / --trace <file> handling shared by the CLIs.
+  // Returns true if argv[i] was one of them (i is advanced past a value).
+  bool parseArg(int argc, const char* const* argv, int& i);
+  // print/write whatever parseArg() requested (stats go to stderr)
+  void report() const;
+
+private:
+  Profiler();
+
+  struct Phase {
+    std::uint64_t count = 0;
+    double totalMs = 0;
+    double maxMs = 0;
+  };
+  struct Event {
+    const char* name;
+    std::int64_t startUs;
+    std::int64_t durUs;
+    std::uint32_t tid;
+    std::size_t rssBytes;
+  };
+
+  std::uint32_t threadIndex(); // caller holds mu_
+
+  std::atomic<bool> enabled_{false};
+  std::atomic<bool> tracing_{false};
+  std::chrono::steady_clock::time_point t0_;
+
+  mutable std::mutex mu_;
+  std::map<std::string, Phase> phases_;
+  std::map<std::string, std::int64_t> counters_;
+  std::vector<Event> events_;
+  std::map<std::thread::id, std::uint32_t> tids_;
+
+  std::string statsFormat_;  // "" = off
+  std::string tracePath_;    // "" = off
+};
+
+/* RAII phase timer: ScopedTimer t("db.write"); (name must outlive the run) */
+class ScopedTimer {
+public:
+  explicit ScopedTimer(const char* phase)
+    : phase_(Profiler::instance().enabled() ? phase : nullptr)
+  {
+    if (phase_) start_ = std::chrono::steady_clock::now();
+  }
+
+  ~ScopedTimer()
+  {
+    if (phase_) Profiler::instance().addPhase(phase_, start_, std::chrono::steady_clock::now());
+  }
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+  const char* phase_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+/* process memory (0 if unavailable) */
+std::size_t peakRssBytes();
+std::size_t currentRssBytes();
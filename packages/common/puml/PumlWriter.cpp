@@ -1,19 +1,101 @@
 #include "puml/PumlWriter.h"
+#include <cstring>
 #include <fstream>
+#include <stdexcept>
+
+static constexpr std::size_t kStreamBufferSize = 1 << 20;
+
+PumlWriter::PumlWriter() = default;
+
+PumlWriter::PumlWriter(const std::string& streamPath) : path_(streamPath) {
+  if (streamPath == "-") {
+    out_ = stdout;
+  } else {
+    out_ = std::fopen(streamPath.c_str(), "wb");
+    if (!out_) throw std::runtime_error("Failed to open output: " + streamPath);
+    ownsOut_ = true;
+  }
+  buf_.resize(kStreamBufferSize);
+}
+
+PumlWriter::~PumlWriter() {
+  if (!out_) return;
+  flush();
+  if (ownsOut_) std::fclose(out_);
+}
+
+void PumlWriter::write(const char* data, std::size_t n) {
+  if (std::fwrite(data, 1, n, out_) != n) failed_ = true;
+}
+
+void PumlWriter::put(std::string_view s) {
+  if (!out_) {
+    cur_.append(s.data(), s.size());
+    return;
+  }
+
+  if (used_ + s.size() > buf_.size()) {
+    flush();
+    if (s.size() > buf_.size()) {
+      write(s.data(), s.size());
+      return;
+    }
+  }
+  std::memcpy(buf_.data() + used_, s.data(), s.size());
+  used_ += s.size();
+}
+
+void PumlWriter::endLine() {
+  if (!out_) {
+    lines_.push_back(std::move(cur_));
+    cur_.clear();
+    return;
+  }
+  put("\n");
+}
+
+void PumlWriter::flush() {
+  if (!out_) return;
+  if (used_ > 0) write(buf_.data(), used_);
+  used_ = 0;
+  if (std::fflush(out_) != 0) failed_ = true;
+}
+
+void PumlWriter::close() {
+  if (!out_) return;
+  flush();
+  if (std::ferror(out_)) failed_ = true;
+  if (ownsOut_ && std::fclose(out_) != 0) failed_ = true;
+  out_ = nullptr;
+  ownsOut_ = false;
+  if (failed_) throw std::runtime_error("Failed to write output: " + (path_ == "-" ? std::string("stdout") : path_));
+}
 
 void PumlWriter::begin() {
-  lines_.push_back("@startuml");
+  line("@startuml");
 }
 
-void PumlWriter::arrow(const std::string& a, const std::string& b) {
-  lines_.push_back("\"" + a + "\" -> \"" + b + "\"");
+void PumlWriter::arrow(std::string_view a, std::string_view b) {
+  line({ "\"", a, "\" -> \"", b, "\"" });
 }
 
 void PumlWriter::end() {
-  lines_.push_back("@enduml");
+  line("@enduml");
+}
+
+void PumlWriter::line(std::string_view text) {
+  put(text);
+  endLine();
+}
+
+void PumlWriter::line(std::initializer_list<std::string_view> parts) {
+  for (auto p : parts) put(p);
+  endLine();
 }
 
 void PumlWriter::save(const std::string& path) const {
   std::ofstream f(path);
   for (auto& l : lines_) f << l << "\n";
+  f.close();
+  if (!f) throw std::runtime_error("Failed to write output: " + path);
 }
@@ -1,14 +1,60 @@
 #pragma once
+#include <cstdio>
+#include <initializer_list>
 #include <string>
+#include <string_view>
 #include <vector>
 
+/*
+ * PlantUML writer
+ * - buffered (default ctor): lines kept in memory, written by save()
+ *   (callers can post-process lines() first)
+ * - streaming (path ctor): written through a large buffer as it goes,
+ *   "-" = stdout; nothing is kept in memory. close() reports a failed
+ *   write / close (disk full, I/O error) as std::runtime_error; the
+ *   destructor closes silently
+ */
 class PumlWriter {
 public:
+  PumlWriter();
+  explicit PumlWriter(const std::string& streamPath);
+  ~PumlWriter();
+
+  PumlWriter(const PumlWriter&) = delete;
+  PumlWriter& operator=(const PumlWriter&) = delete;
+
   void begin();
-  void arrow(const std::string& a, const std::string& b);
+  void arrow(std::string_view a, std::string_view b);
   void end();
+
+  // one output line, assembled from pieces without temporaries
+  void line(std::string_view text);
+  void line(std::initializer_list<std::string_view> parts);
+
+  bool streaming() const { return out_ != nullptr; }
+  void flush();
+  // flush + close (stdout: flush only); throws if any write failed.
+  // Nothing may be written afterwards.
+  void close();
+
+  /* buffered mode only */
   void save(const std::string& path) const;
+  const std::vector<std::string>& lines() const { return lines_; }
 
 private:
+  void put(std::string_view s);
+  void endLine();
+  void write(const char* data, std::size_t n);
+
+  /* buffered */
   std::vector<std::string> lines_;
+  std::string cur_;
+
+  /* streaming */
+  std::FILE* out_ = nullptr;
+  bool ownsOut_ = false;
+  bool failed_ = false;
+  std::string path_;
+  std::vector<char> buf_;
+  std::size_t used_ = 0;
 };
@@ -1,7 +1,10 @@
 #include "storage/SqliteStore.h"
+#include "profile/Profiler.h"
 
 #include <sqlite3.h>
+#include <algorithm>
 #include <stdexcept>
+#include <unordered_set>
 #include <iostream>
 
 /* ============================================================
@@ -18,6 +21,13 @@ SqliteStore::SqliteStore(const std::string& dbPath)
 
 SqliteStore::~SqliteStore()
 {
+  sqlite3_finalize(reinterpret_cast<sqlite3_stmt*>(insertFunctionStmt_));
+  sqlite3_finalize(reinterpret_cast<sqlite3_stmt*>(insertCallStmt_));
+  sqlite3_finalize(reinterpret_cast<sqlite3_stmt*>(insertFactStmt_));
+  sqlite3_finalize(reinterpret_cast<sqlite3_stmt*>(insertDepStmt_));
+  sqlite3_finalize(reinterpret_cast<sqlite3_stmt*>(internStmt_));
+  sqlite3_finalize(reinterpret_cast<sqlite3_stmt*>(lookupIdStmt_));
+
   if (db_) {
     sqlite3_close(reinterpret_cast<sqlite3*>(db_));
     db_ = nullptr;
@@ -25,38 +35,371 @@ SqliteStore::~SqliteStore()
 }
 
 /* ============================================================
- * Schema (Indexer)
+ * Helpers
  * ============================================================ */
 
-void SqliteStore::initSchema()
+void SqliteStore::exec(const std::string& sql)
 {
-  const char* sql = R"(
+  char* err = nullptr;
+  if (sqlite3_exec(reinterpret_cast<sqlite3*>(db_), sql.c_str(), nullptr, nullptr, &err) != SQLITE_OK) {
+    std::string msg = err ? err : "Unknown error";
+    sqlite3_free(err);
+    throw std::runtime_error("SQL failed (" + sql + "): " + msg);
+  }
+}
+
+std::string SqliteStore::queryText(const char* sql) const
+{
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+  sqlite3_stmt* stmt = nullptr;
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    throw std::runtime_error(std::string("prepare failed: ") + sqlite3_errmsg(db));
+  }
+
+  std::string out;
+  if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_text(stmt, 0)) {
+    out = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+  }
+  sqlite3_finalize(stmt);
+  return out;
+}
+
+void* SqliteStore::prepareCached(void*& slot, const char* sql)
+{
+  if (!slot) {
+    sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+      throw std::runtime_error(std::string("prepare failed: ") + sqlite3_errmsg(db));
+    }
+    slot = stmt;
+  }
+  return slot;
+}
+
+void* SqliteStore::prepareRead(const char* sql) const
+{
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+  sqlite3_stmt* stmt = nullptr;
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    throw std::runtime_error(std::string("prepare failed: ") + sqlite3_errmsg(db));
+  }
+  return stmt;
+}
+
+static std::string columnText(sqlite3_stmt* stmt, int col)
+{
+  const unsigned char* text = sqlite3_column_text(stmt, col);
+  return text ? reinterpret_cast<const char*>(text) : std::string();
+}
+
+static void stepDone(sqlite3* db, sqlite3_stmt* stmt)
+{
+  int rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+  if (rc != SQLITE_DONE) {
+    throw std::runtime_error(std::string("write failed: ") + sqlite3_errmsg(db));
+  }
+}
+
+/* ============================================================
+ * Transaction / IndexingSession
+ * ============================================================ */
+
+SqliteStore::Transaction::Transaction(SqliteStore& store)
+  : store_(store), depth_(store.txnDepth_)
+{
+  if (depth_ == 0) {
+    store_.exec("BEGIN IMMEDIATE;");
+  } else {
+    store_.exec("SAVEPOINT sp" + std::to_string(depth_) + ";");
+  }
+  ++store_.txnDepth_;
+}
+
+SqliteStore::Transaction::~Transaction()
+{
+  if (done_) return;
+
+  // rollback must not throw from a destructor
+  --store_.txnDepth_;
+  store_.usrIds_.clear();   // ids handed out inside the rolled back scope are gone
+  const std::string sql = (depth_ == 0)
+    ? std::string("ROLLBACK;")
+    : "ROLLBACK TO sp" + std::to_string(depth_) + "; RELEASE sp" + std::to_string(depth_) + ";";
+  sqlite3_exec(reinterpret_cast<sqlite3*>(store_.db_), sql.c_str(), nullptr, nullptr, nullptr);
+}
+
+void SqliteStore::Transaction::commit()
+{
+  if (done_) return;
+
+  store_.exec(depth_ == 0 ? std::string("COMMIT;")
+                          : "RELEASE sp" + std::to_string(depth_) + ";");
+  done_ = true;
+  --store_.txnDepth_;
+}
+
+SqliteStore::IndexingSession::IndexingSession(SqliteStore& store)
+  : store_(store)
+{
+  journalMode_ = store_.queryText("PRAGMA journal_mode;");
+  synchronous_ = store_.queryText("PRAGMA synchronous;");
+
+  // journal_mode returns the resulting mode as a row
+  store_.queryText("PRAGMA journal_mode=WAL;");
+  store_.exec("PRAGMA synchronous=NORMAL;");
+}
+
+SqliteStore::IndexingSession::~IndexingSession()
+{
+  sqlite3* db = reinterpret_cast<sqlite3*>(store_.db_);
+
+  const std::string restore =
+    "PRAGMA wal_checkpoint(TRUNCATE);"
+    "PRAGMA journal_mode=" + (journalMode_.empty() ? std::string("DELETE") : journalMode_) + ";"
+    "PRAGMA synchronous=" + (synchronous_.empty() ? std::string("FULL") : synchronous_) + ";";
+  sqlite3_exec(db, restore.c_str(), nullptr, nullptr, nullptr);
+}
+
+void SqliteStore::setBatchSize(std::size_t rows)
+{
+  batchSize_ = rows == 0 ? 1 : rows;
+}
+
+void SqliteStore::writeBatched(std::size_t rows, const std::function<void(std::size_t)>& writeRow)
+{
+  if (txnDepth_ > 0) {
+    for (std::size_t i = 0; i < rows; ++i) writeRow(i);
+    return;
+  }
+
+  std::size_t i = 0;
+  while (i < rows) {
+    Transaction txn(*this);
+    const std::size_t end = std::min(rows, i + batchSize_);
+    for (; i < end; ++i) writeRow(i);
+    txn.commit();
+  }
+}
+
+/* ============================================================
+ * Schema (Indexer)
+ * - v1: USR text keys in sud_call (legacy, user_version 0)
+ * - v2: integer function ids, sud_call(caller_id, callee_id)
+ * - v3: sud_file (path, content hash); functions/calls owned by a file
+ * - v4: sud_function(name) index for name -> id lookups
+ * - v5: sud_call(line, seq) call-site position; caller index ordered by seq
+ * - v6: sud_meta (graph generation), SCC condensation cache (sud_scc*)
+ * - v7: reachability index over the condensation (sud_reach*)
+ * - v8: sud_call.kind (resolved indirect calls), function pointer facts (sud_ptr_fact)
+ * - v9: headers each file was indexed against (sud_file_dep)
+ * ============================================================ */
+
+static const char* kSchemaV2 = R"(
     CREATE TABLE IF NOT EXISTS sud_function (
-      usr        TEXT PRIMARY KEY,
+      id         INTEGER PRIMARY KEY,
+      usr        TEXT NOT NULL UNIQUE,
       name       TEXT NOT NULL,
       file       TEXT NOT NULL
     );
 
     CREATE TABLE IF NOT EXISTS sud_call (
-      caller_usr TEXT NOT NULL,
-      callee_usr TEXT NOT NULL,
-      FOREIGN KEY(caller_usr) REFERENCES sud_function(usr),
-      FOREIGN KEY(callee_usr) REFERENCES sud_function(usr)
+      caller_id  INTEGER NOT NULL REFERENCES sud_function(id),
+      callee_id  INTEGER NOT NULL REFERENCES sud_function(id)
     );
 
     CREATE INDEX IF NOT EXISTS idx_sud_call_caller
-      ON sud_call(caller_usr);
+      ON sud_call(caller_id, callee_id);
 
     CREATE INDEX IF NOT EXISTS idx_sud_call_callee
-      ON sud_call(callee_usr);
+      ON sud_call(callee_id, caller_id);
   )";
 
-  char* err = nullptr;
-  if (sqlite3_exec(reinterpret_cast<sqlite3*>(db_), sql, nullptr, nullptr, &err) != SQLITE_OK) {
-    std::string msg = err ? err : "Unknown error";
-    sqlite3_free(err);
-    throw std::runtime_error("initSchema failed: " + msg);
+static const char* kMigrateV2toV3 = R"(
+    CREATE TABLE IF NOT EXISTS sud_file (
+      id         INTEGER PRIMARY KEY,
+      path       TEXT NOT NULL UNIQUE,
+      hash       TEXT NOT NULL
+    );
+
+    ALTER TABLE sud_function ADD COLUMN file_id INTEGER REFERENCES sud_file(id);
+    ALTER TABLE sud_call ADD COLUMN file_id INTEGER REFERENCES sud_file(id);
+
+    CREATE INDEX IF NOT EXISTS idx_sud_function_file
+      ON sud_function(file_id);
+
+    CREATE INDEX IF NOT EXISTS idx_sud_call_file
+      ON sud_call(file_id);
+  )";
+
+static const char* kMigrateV3toV4 = R"(
+    CREATE INDEX IF NOT EXISTS idx_sud_function_name
+      ON sud_function(name);
+  )";
+
+static const char* kMigrateV4toV5 = R"(
+    ALTER TABLE sud_call ADD COLUMN line INTEGER NOT NULL DEFAULT 0;
+    ALTER TABLE sud_call ADD COLUMN seq INTEGER NOT NULL DEFAULT 0;
+
+    DROP INDEX IF EXISTS idx_sud_call_caller;
+    CREATE INDEX idx_sud_call_caller
+      ON sud_call(caller_id, seq, callee_id);
+  )";
+
+static const char* kMigrateV5toV6 = R"(
+    CREATE TABLE IF NOT EXISTS sud_meta (
+      key        TEXT PRIMARY KEY,
+      value      INTEGER NOT NULL
+    );
+    INSERT OR IGNORE INTO sud_meta (key, value) VALUES ('generation', 1);
+
+    CREATE TABLE IF NOT EXISTS sud_scc (
+      function_id  INTEGER PRIMARY KEY,
+      component    INTEGER NOT NULL
+    );
+
+    CREATE INDEX IF NOT EXISTS idx_sud_scc_component
+      ON sud_scc(component);
+
+    CREATE TABLE IF NOT EXISTS sud_scc_component (
+      id         INTEGER PRIMARY KEY,
+      size       INTEGER NOT NULL,
+      recursive  INTEGER NOT NULL
+    );
+
+    CREATE TABLE IF NOT EXISTS sud_scc_edge (
+      from_component  INTEGER NOT NULL,
+      to_component    INTEGER NOT NULL,
+      PRIMARY KEY (from_component, to_component)
+    ) WITHOUT ROWID;
+  )";
+
+static const char* kMigrateV6toV7 = R"(
+    CREATE INDEX IF NOT EXISTS idx_sud_scc_edge_to
+      ON sud_scc_edge(to_component, from_component);
+
+    CREATE TABLE IF NOT EXISTS sud_reach_component (
+      id         INTEGER PRIMARY KEY,
+      post       INTEGER NOT NULL,
+      exact      INTEGER NOT NULL
+    );
+
+    CREATE UNIQUE INDEX IF NOT EXISTS idx_sud_reach_post
+      ON sud_reach_component(post);
+
+    CREATE TABLE IF NOT EXISTS sud_reach_interval (
+      component  INTEGER NOT NULL,
+      lo         INTEGER NOT NULL,
+      hi         INTEGER NOT NULL,
+      exact      INTEGER NOT NULL,
+      PRIMARY KEY (component, lo)
+    ) WITHOUT ROWID;
+  )";
+
+// indirect rows are few and replaced as a whole: partial index only
+static const char* kMigrateV7toV8 = R"(
+    ALTER TABLE sud_call ADD COLUMN kind INTEGER NOT NULL DEFAULT 0;
+
+    CREATE INDEX IF NOT EXISTS idx_sud_call_indirect
+      ON sud_call(kind) WHERE kind <> 0;
+
+    CREATE TABLE IF NOT EXISTS sud_ptr_fact (
+      file_id    INTEGER NOT NULL REFERENCES sud_file(id),
+      kind       INTEGER NOT NULL,
+      cell       TEXT NOT NULL,
+      source     TEXT NOT NULL,
+      name       TEXT NOT NULL,
+      line       INTEGER NOT NULL,
+      seq        INTEGER NOT NULL
+    );
+
+    CREATE INDEX IF NOT EXISTS idx_sud_ptr_fact_file
+      ON sud_ptr_fact(file_id);
+  )";
+
+// files indexed before v9 have no dependency list: cleared hashes
+// make the next run re-index them once
+static const char* kMigrateV8toV9 = R"(
+    CREATE TABLE IF NOT EXISTS sud_file_dep (
+      file_id    INTEGER NOT NULL REFERENCES sud_file(id),
+      path       TEXT NOT NULL,
+      hash       TEXT NOT NULL,
+      PRIMARY KEY (file_id, path)
+    ) WITHOUT ROWID;
+
+    UPDATE sud_file SET hash = '';
+  )";
+
+int SqliteStore::schemaVersion() const
+{
+  const std::string v = queryText("PRAGMA user_version;");
+  if (v != "0") return v.empty() ? 0 : std::stoi(v);
+
+  // user_version 0: either an empty DB or a legacy (v1) text-keyed one
+  const std::string legacy = queryText(
+    "SELECT COUNT(*) FROM pragma_table_info('sud_call') WHERE name = 'caller_usr';");
+  return legacy == "1" ? 1 : 0;
+}
+
+void SqliteStore::initSchema()
+{
+  ScopedTimer timer("db.schema");
+  const int version = schemaVersion();
+  if (version > kSchemaVersion) {
+    throw std::runtime_error("initSchema failed: DB schema v" + std::to_string(version) +
+                             " is newer than supported v" + std::to_string(kSchemaVersion));
   }
+  if (version == kSchemaVersion) return;
+
+  // step-wise: every DB walks the same migration chain
+  Transaction txn(*this);
+  if (version == 0) exec(kSchemaV2);
+  if (version == 1) migrateV1toV2();
+  if (version <= 2) exec(kMigrateV2toV3);
+  if (version <= 3) exec(kMigrateV3toV4);
+  if (version <= 4) exec(kMigrateV4toV5);
+  if (version <= 5) exec(kMigrateV5toV6);
+  if (version <= 6) exec(kMigrateV6toV7);
+  if (version <= 7) exec(kMigrateV7toV8);
+  if (version <= 8) exec(kMigrateV8toV9);
+  exec("PRAGMA user_version = " + std::to_string(kSchemaVersion) + ";");
+  txn.commit();
+}
+
+void SqliteStore::migrateV1toV2()
+{
+  // text-keyed rows are copied in rowid order; USRs only seen in sud_call
+  // become stub functions (name = USR, file = "")
+  exec(R"(
+    ALTER TABLE sud_function RENAME TO sud_function_v1;
+    ALTER TABLE sud_call RENAME TO sud_call_v1;
+    DROP INDEX IF EXISTS idx_sud_call_caller;
+    DROP INDEX IF EXISTS idx_sud_call_callee;
+  )");
+
+  exec(kSchemaV2);
+
+  exec(R"(
+    INSERT INTO sud_function (usr, name, file)
+      SELECT usr, name, file FROM sud_function_v1 ORDER BY rowid;
+
+    INSERT OR IGNORE INTO sud_function (usr, name, file)
+      SELECT caller_usr, caller_usr, '' FROM sud_call_v1 ORDER BY rowid;
+
+    INSERT OR IGNORE INTO sud_function (usr, name, file)
+      SELECT callee_usr, callee_usr, '' FROM sud_call_v1 ORDER BY rowid;
+
+    INSERT INTO sud_call (caller_id, callee_id)
+      SELECT a.id, b.id
+        FROM sud_call_v1 c
+        JOIN sud_function a ON a.usr = c.caller_usr
+        JOIN sud_function b ON b.usr = c.callee_usr
+       ORDER BY c.rowid;
+
+    DROP TABLE sud_call_v1;
+    DROP TABLE sud_function_v1;
+  )");
 }
 
 /* ============================================================
@@ -65,41 +408,51 @@ void SqliteStore::initSchema()
 
 SudModel SqliteStore::loadSudModel() const
 {
+  ScopedTimer timer("db.load");
   SudModel model;
   sqlite3* db = reinterpret_cast<sqlite3*>(db_);
 
+  // sud_function.id -> index into model.functions
+  std::vector<std::uint32_t> idToIndex;
+
   /* ---- load functions ---- */
   {
     const char* sql =
-      "SELECT usr, name, file FROM sud_function;";
+      "SELECT id, usr, name, file FROM sud_function ORDER BY id;";
 
     sqlite3_stmt* stmt = nullptr;
     sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
       SudFunction f;
-      f.usr  = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-      f.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-      f.file = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+      f.id   = sqlite3_column_int64(stmt, 0);
+      f.usr  = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+      f.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+      f.file = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+
+      if ((std::size_t)f.id >= idToIndex.size()) idToIndex.resize((std::size_t)f.id + 1, UINT32_MAX);
+      idToIndex[(std::size_t)f.id] = (std::uint32_t)model.functions.size();
       model.functions.push_back(std::move(f));
     }
 
     sqlite3_finalize(stmt);
   }
 
-  /* ---- load calls ---- */
+  /* ---- load calls (integer pairs only, no per-edge strings) ---- */
+  // caller, then call-site order: SudGraph keeps this order per node
   {
     const char* sql =
-      "SELECT caller_usr, callee_usr FROM sud_call;";
+      "SELECT caller_id, callee_id, line FROM sud_call ORDER BY caller_id, seq, rowid;";
 
     sqlite3_stmt* stmt = nullptr;
     sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-      SudCall c;
-      c.callerUSR = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
-      c.calleeUSR = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
-      model.calls.push_back(std::move(c));
+      const auto a = (std::size_t)sqlite3_column_int64(stmt, 0);
+      const auto b = (std::size_t)sqlite3_column_int64(stmt, 1);
+      if (a >= idToIndex.size() || b >= idToIndex.size()) continue;
+      if (idToIndex[a] == UINT32_MAX || idToIndex[b] == UINT32_MAX) continue;
+      model.edges.push_back(SudEdge{ idToIndex[a], idToIndex[b], (std::uint32_t)sqlite3_column_int(stmt, 2) });
     }
 
     sqlite3_finalize(stmt);
@@ -108,47 +461,831 @@ SudModel SqliteStore::loadSudModel() const
   return model;
 }
 
+std::int64_t SqliteStore::internUsr(const std::string& usr, const std::string& name)
+{
+  auto it = usrIds_.find(usr);
+  if (it != usrIds_.end()) return it->second;
+
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+  auto* ins = reinterpret_cast<sqlite3_stmt*>(prepareCached(internStmt_,
+    "INSERT OR IGNORE INTO sud_function (usr, name, file) VALUES (?, ?, '');"));
+  const std::string& stubName = name.empty() ? usr : name;
+  sqlite3_bind_text(ins, 1, usr.c_str(), (int)usr.size(), SQLITE_STATIC);
+  sqlite3_bind_text(ins, 2, stubName.c_str(), (int)stubName.size(), SQLITE_STATIC);
+  stepDone(db, ins);
+
+  auto* sel = reinterpret_cast<sqlite3_stmt*>(prepareCached(lookupIdStmt_,
+    "SELECT id FROM sud_function WHERE usr = ?;"));
+  sqlite3_bind_text(sel, 1, usr.c_str(), (int)usr.size(), SQLITE_STATIC);
+  std::int64_t id = 0;
+  if (sqlite3_step(sel) == SQLITE_ROW) id = sqlite3_column_int64(sel, 0);
+  sqlite3_reset(sel);
+  if (id == 0) {
+    throw std::runtime_error("failed to intern USR: " + usr);
+  }
+
+  usrIds_.emplace(usr, id);
+  return id;
+}
+
 void SqliteStore::insertFunctions(const std::vector<SudFunction>& funcs)
 {
+  writeFunctions(funcs, 0);
+  bumpGeneration();
+}
+
+void SqliteStore::insertCalls(const std::vector<SudCall>& calls)
+{
+  writeCalls(calls, 0);
+  bumpGeneration();
+}
+
+void SqliteStore::writeFunctions(const std::vector<SudFunction>& funcs, std::int64_t fileId)
+{
+  ScopedTimer timer("db.write");
+  Profiler::instance().count("db.functions", (std::int64_t)funcs.size());
+
   sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+  // a stub (file = '') is upgraded in place so its id stays stable; within one
+  // file the first definition wins, but a row owned by another file is taken
+  // over, so a definition that moved survives the old file being re-indexed
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareCached(insertFunctionStmt_,
+    "INSERT INTO sud_function (usr, name, file, file_id) VALUES (?, ?, ?, ?) "
+    "ON CONFLICT(usr) DO UPDATE SET name = excluded.name, file = excluded.file, "
+    "file_id = excluded.file_id "
+    "WHERE sud_function.file = '' "
+    "OR (excluded.file_id IS NOT NULL AND sud_function.file_id IS NOT excluded.file_id);"));
 
-  const char* sql =
-    "INSERT OR IGNORE INTO sud_function (usr, name, file) VALUES (?, ?, ?);";
+  writeBatched(funcs.size(), [&](std::size_t i) {
+    const auto& f = funcs[i];
+    sqlite3_bind_text(stmt, 1, f.usr.c_str(), (int)f.usr.size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, f.name.c_str(), (int)f.name.size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, f.file.c_str(), (int)f.file.size(), SQLITE_STATIC);
+    if (fileId) sqlite3_bind_int64(stmt, 4, fileId);
+    else        sqlite3_bind_null(stmt, 4);
+    stepDone(db, stmt);
+  });
+}
+
+void SqliteStore::writeCalls(const std::vector<SudCall>& calls, std::int64_t fileId)
+{
+  ScopedTimer timer("db.write");
+  Profiler::instance().count("db.calls", (std::int64_t)calls.size());
+
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareCached(insertCallStmt_,
+    "INSERT INTO sud_call (caller_id, callee_id, file_id, line, seq, kind) VALUES (?, ?, ?, ?, ?, ?);"));
+
+  writeBatched(calls.size(), [&](std::size_t i) {
+    const auto& c = calls[i];
+    sqlite3_bind_int64(stmt, 1, internUsr(c.callerUSR, c.callerName));
+    sqlite3_bind_int64(stmt, 2, internUsr(c.calleeUSR, c.calleeName));
+    if (fileId) sqlite3_bind_int64(stmt, 3, fileId);
+    else        sqlite3_bind_null(stmt, 3);
+    sqlite3_bind_int(stmt, 4, c.line);
+    sqlite3_bind_int(stmt, 5, c.seq);
+    sqlite3_bind_int(stmt, 6, (int)c.kind);
+    stepDone(db, stmt);
+  });
+}
+
+/* ============================================================
+ * Incremental indexing (per source file)
+ * ============================================================ */
+
+std::unordered_map<std::string, SudFile> SqliteStore::loadFiles() const
+{
+  std::unordered_map<std::string, SudFile> out;
+  std::unordered_map<std::int64_t, SudFile*> byId;
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
 
   sqlite3_stmt* stmt = nullptr;
-  sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+  sqlite3_prepare_v2(db, "SELECT id, path, hash FROM sud_file;", -1, &stmt, nullptr);
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    SudFile f;
+    f.path = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+    f.hash = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+    std::string path = f.path;
+    byId[sqlite3_column_int64(stmt, 0)] = &out.emplace(std::move(path), std::move(f)).first->second;
+  }
+  sqlite3_finalize(stmt);
+
+  sqlite3_prepare_v2(db, "SELECT file_id, path, hash FROM sud_file_dep;", -1, &stmt, nullptr);
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    auto it = byId.find(sqlite3_column_int64(stmt, 0));
+    if (it == byId.end()) continue;
+    it->second->deps.push_back(SudFileDep{
+      reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)),
+      reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2))
+    });
+  }
+  sqlite3_finalize(stmt);
+  return out;
+}
 
-  for (const auto& f : funcs) {
-    sqlite3_bind_text(stmt, 1, f.usr.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, f.name.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 3, f.file.c_str(), -1, SQLITE_TRANSIENT);
+void SqliteStore::replaceFile(const SudFile& file,
+                              const std::vector<SudFunction>& funcs,
+                              const std::vector<SudCall>& calls,
+                              const std::vector<SudPtrFact>& facts)
+{
+  ScopedTimer timer("db.replaceFile");
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+  Transaction txn(*this);
 
-    sqlite3_step(stmt);
-    sqlite3_reset(stmt);
+  /* ---- file row ---- */
+  std::int64_t fileId = 0;
+  {
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db,
+      "INSERT INTO sud_file (path, hash) VALUES (?, ?) "
+      "ON CONFLICT(path) DO UPDATE SET hash = excluded.hash;", -1, &stmt, nullptr);
+    sqlite3_bind_text(stmt, 1, file.path.c_str(), (int)file.path.size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, file.hash.c_str(), (int)file.hash.size(), SQLITE_STATIC);
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+      throw std::runtime_error(std::string("replaceFile failed: ") + sqlite3_errmsg(db));
+    }
+
+    sqlite3_prepare_v2(db, "SELECT id FROM sud_file WHERE path = ?;", -1, &stmt, nullptr);
+    sqlite3_bind_text(stmt, 1, file.path.c_str(), (int)file.path.size(), SQLITE_STATIC);
+    if (sqlite3_step(stmt) == SQLITE_ROW) fileId = sqlite3_column_int64(stmt, 0);
+    sqlite3_finalize(stmt);
   }
 
+  /* ---- drop previous content of this file ---- */
+  dropFileContent(fileId);
+
+  /* ---- new content ---- */
+  writeFunctions(funcs, fileId);
+  writeCalls(calls, fileId);
+  writePointerFacts(facts, fileId);
+  writeFileDeps(file.deps, fileId);
+  bumpGeneration();
+
+  txn.commit();
+}
+
+bool SqliteStore::removeFile(const std::string& path)
+{
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+  Transaction txn(*this);
+
+  std::int64_t fileId = 0;
+  {
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db, "SELECT id FROM sud_file WHERE path = ?;", -1, &stmt, nullptr);
+    sqlite3_bind_text(stmt, 1, path.c_str(), (int)path.size(), SQLITE_STATIC);
+    if (sqlite3_step(stmt) == SQLITE_ROW) fileId = sqlite3_column_int64(stmt, 0);
+    sqlite3_finalize(stmt);
+  }
+  if (fileId == 0) return false;
+
+  dropFileContent(fileId);
+  exec("DELETE FROM sud_file WHERE id = " + std::to_string(fileId) + ";");
+  bumpGeneration();
+
+  txn.commit();
+  return true;
+}
+
+void SqliteStore::dropFileContent(std::int64_t fileId)
+{
+  // functions still owned by this file are demoted to stubs (not deleted) so
+  // ids referenced by other files' calls stay valid; rows another file has
+  // taken over are left alone. pruneStubs() collects the orphans
+  const std::string id = std::to_string(fileId);
+  exec("DELETE FROM sud_call WHERE file_id = " + id + ";");
+  exec("DELETE FROM sud_ptr_fact WHERE file_id = " + id + ";");
+  exec("DELETE FROM sud_file_dep WHERE file_id = " + id + ";");
+  exec("UPDATE sud_function SET file = '', file_id = NULL WHERE file_id = " + id + ";");
+}
+
+void SqliteStore::writeFileDeps(const std::vector<SudFileDep>& deps, std::int64_t fileId)
+{
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareCached(insertDepStmt_,
+    "INSERT OR REPLACE INTO sud_file_dep (file_id, path, hash) VALUES (?, ?, ?);"));
+
+  writeBatched(deps.size(), [&](std::size_t i) {
+    const auto& d = deps[i];
+    sqlite3_bind_int64(stmt, 1, fileId);
+    sqlite3_bind_text(stmt, 2, d.path.c_str(), (int)d.path.size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, d.hash.c_str(), (int)d.hash.size(), SQLITE_STATIC);
+    stepDone(db, stmt);
+  });
+}
+
+void SqliteStore::writePointerFacts(const std::vector<SudPtrFact>& facts, std::int64_t fileId)
+{
+  Profiler::instance().count("db.ptrFacts", (std::int64_t)facts.size());
+
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareCached(insertFactStmt_,
+    "INSERT INTO sud_ptr_fact (file_id, kind, cell, source, name, line, seq) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?);"));
+
+  writeBatched(facts.size(), [&](std::size_t i) {
+    const auto& f = facts[i];
+    sqlite3_bind_int64(stmt, 1, fileId);
+    sqlite3_bind_int(stmt, 2, (int)f.kind);
+    sqlite3_bind_text(stmt, 3, f.cell.c_str(), (int)f.cell.size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, f.source.c_str(), (int)f.source.size(), SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 5, f.name.c_str(), (int)f.name.size(), SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 6, f.line);
+    sqlite3_bind_int(stmt, 7, f.seq);
+    stepDone(db, stmt);
+  });
+}
+
+/* ============================================================
+ * Function pointer facts / resolved indirect calls
+ * ============================================================ */
+
+std::vector<SudPtrFact> SqliteStore::loadPointerFacts() const
+{
+  ScopedTimer timer("db.ptrFacts.load");
+  std::vector<SudPtrFact> out;
+
+  // insertion order keeps each file's call facts in call-site order
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareRead(
+    "SELECT kind, cell, source, name, line, seq FROM sud_ptr_fact ORDER BY rowid;"));
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    SudPtrFact f;
+    f.kind = (SudPtrFactKind)sqlite3_column_int(stmt, 0);
+    f.cell = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+    f.source = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+    f.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+    f.line = sqlite3_column_int(stmt, 4);
+    f.seq = sqlite3_column_int(stmt, 5);
+    out.push_back(std::move(f));
+  }
   sqlite3_finalize(stmt);
+  return out;
 }
 
-void SqliteStore::insertCalls(const std::vector<SudCall>& calls)
+void SqliteStore::replaceIndirectCalls(const std::vector<SudCall>& calls)
+{
+  ScopedTimer timer("db.indirect.save");
+  Transaction txn(*this);
+
+  exec("DELETE FROM sud_call WHERE kind <> 0;");
+  writeCalls(calls, 0);
+  bumpGeneration();
+
+  txn.commit();
+}
+
+void SqliteStore::pruneStubs()
+{
+  ScopedTimer timer("db.prune");
+  exec(R"(
+    DELETE FROM sud_function
+     WHERE file_id IS NULL AND file = ''
+       AND NOT EXISTS (SELECT 1 FROM sud_call WHERE caller_id = sud_function.id)
+       AND NOT EXISTS (SELECT 1 FROM sud_call WHERE callee_id = sud_function.id);
+  )");
+  if (sqlite3_changes(reinterpret_cast<sqlite3*>(db_)) > 0) bumpGeneration();
+  usrIds_.clear();
+}
+
+/* ============================================================
+ * Bounded subgraph queries (Diagram)
+ * ============================================================ */
+
+// bit 1: follow callees, bit 2: follow callers (bound as ?3 in the CTEs)
+static int directionMask(SqliteStore::Direction dir)
+{
+  switch (dir) {
+    case SqliteStore::Direction::Callees: return 1;
+    case SqliteStore::Direction::Callers: return 2;
+    case SqliteStore::Direction::Both: return 3;
+  }
+  return 0;
+}
+
+std::int64_t SqliteStore::findFunctionId(const std::string& usrOrName) const
 {
   sqlite3* db = reinterpret_cast<sqlite3*>(db_);
 
+  // USR first, then the lowest id carrying that name (both indexed);
+  // a defined function is preferred over a stub of the same name
   const char* sql =
-    "INSERT INTO sud_call (caller_usr, callee_usr) VALUES (?, ?);";
+    "SELECT id FROM sud_function WHERE usr = ?1 "
+    "UNION ALL "
+    "SELECT * FROM (SELECT id FROM sud_function WHERE name = ?1 ORDER BY file = '', id LIMIT 1) "
+    "LIMIT 1;";
 
   sqlite3_stmt* stmt = nullptr;
   sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr);
+  sqlite3_bind_text(stmt, 1, usrOrName.c_str(), (int)usrOrName.size(), SQLITE_STATIC);
 
-  for (const auto& c : calls) {
-    sqlite3_bind_text(stmt, 1, c.callerUSR.c_str(), -1, SQLITE_TRANSIENT);
-    sqlite3_bind_text(stmt, 2, c.calleeUSR.c_str(), -1, SQLITE_TRANSIENT);
+  std::int64_t id = 0;
+  if (sqlite3_step(stmt) == SQLITE_ROW) id = sqlite3_column_int64(stmt, 0);
+  sqlite3_finalize(stmt);
+  return id;
+}
 
-    sqlite3_step(stmt);
+SudModel SqliteStore::loadSubgraph(std::int64_t rootId, int depth, Direction dir) const
+{
+  ScopedTimer timer("db.subgraph");
+  SudModel model;
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+
+  const int mask = directionMask(dir);
+
+  // BFS runs inside SQLite over idx_sud_call_caller / idx_sud_call_callee;
+  // edges are taken from nodes closer than `depth` and deduplicated
+  const char* sql = R"(
+    WITH RECURSIVE
+      down(id, depth) AS (
+        SELECT ?1, 0
+        UNION
+        SELECT c.callee_id, d.depth + 1
+          FROM down d JOIN sud_call c ON c.caller_id = d.id
+         WHERE d.depth < ?2 AND (?3 & 1)
+      ),
+      up(id, depth) AS (
+        SELECT ?1, 0
+        UNION
+        SELECT c.caller_id, u.depth + 1
+          FROM up u JOIN sud_call c ON c.callee_id = u.id
+         WHERE u.depth < ?2 AND (?3 & 2)
+      ),
+      dn(id, depth) AS (SELECT id, MIN(depth) FROM down GROUP BY id),
+      un(id, depth) AS (SELECT id, MIN(depth) FROM up GROUP BY id)
+    SELECT c.caller_id, c.callee_id
+      FROM dn JOIN sud_call c ON c.caller_id = dn.id
+     WHERE dn.depth < ?2 AND (?3 & 1)
+    UNION
+    SELECT c.caller_id, c.callee_id
+      FROM un JOIN sud_call c ON c.callee_id = un.id
+     WHERE un.depth < ?2 AND (?3 & 2)
+    ORDER BY 1, 2;
+  )";
+
+  sqlite3_stmt* stmt = nullptr;
+  if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+    throw std::runtime_error(std::string("loadSubgraph failed: ") + sqlite3_errmsg(db));
+  }
+  sqlite3_bind_int64(stmt, 1, rootId);
+  sqlite3_bind_int(stmt, 2, depth);
+  sqlite3_bind_int(stmt, 3, mask);
+
+  // sud_function.id -> index into model.functions (root first)
+  std::unordered_map<std::int64_t, std::uint32_t> index;
+  std::vector<std::int64_t> ids;
+  auto indexOf = [&](std::int64_t id) {
+    auto it = index.find(id);
+    if (it != index.end()) return it->second;
+    const auto i = (std::uint32_t)ids.size();
+    index.emplace(id, i);
+    ids.push_back(id);
+    return i;
+  };
+
+  indexOf(rootId);
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    const auto a = indexOf(sqlite3_column_int64(stmt, 0));
+    const auto b = indexOf(sqlite3_column_int64(stmt, 1));
+    model.edges.push_back(SudEdge{ a, b });
+  }
+  sqlite3_finalize(stmt);
+
+  /* ---- function rows for the touched ids only ---- */
+  sqlite3_prepare_v2(db,
+    "SELECT usr, name, file FROM sud_function WHERE id = ?;", -1, &stmt, nullptr);
+
+  model.functions.reserve(ids.size());
+  for (std::int64_t id : ids) {
+    SudFunction f;
+    f.id = id;
+    sqlite3_bind_int64(stmt, 1, id);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+      f.usr  = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+      f.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+      f.file = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2));
+    }
     sqlite3_reset(stmt);
+    model.functions.push_back(std::move(f));
+  }
+  sqlite3_finalize(stmt);
+
+  return model;
+}
+
+/* ============================================================
+ * Scoped reads (cursor based)
+ * ============================================================ */
+
+SqliteStore::FunctionCursor::FunctionCursor(FunctionCursor&& other) noexcept
+  : stmt_(other.stmt_), row_(std::move(other.row_)), hops_(other.hops_), line_(other.line_)
+{
+  other.stmt_ = nullptr;
+}
+
+SqliteStore::FunctionCursor& SqliteStore::FunctionCursor::operator=(FunctionCursor&& other) noexcept
+{
+  if (this != &other) {
+    sqlite3_finalize(reinterpret_cast<sqlite3_stmt*>(stmt_));
+    stmt_ = other.stmt_;
+    row_ = std::move(other.row_);
+    hops_ = other.hops_;
+    line_ = other.line_;
+    other.stmt_ = nullptr;
   }
+  return *this;
+}
+
+SqliteStore::FunctionCursor::~FunctionCursor()
+{
+  sqlite3_finalize(reinterpret_cast<sqlite3_stmt*>(stmt_));
+}
+
+bool SqliteStore::FunctionCursor::next()
+{
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(stmt_);
+  if (!stmt) return false;
+
+  const int rc = sqlite3_step(stmt);
+  if (rc != SQLITE_ROW) {
+    const std::string err = sqlite3_errmsg(sqlite3_db_handle(stmt));
+    sqlite3_finalize(stmt);
+    stmt_ = nullptr;
+    if (rc != SQLITE_DONE) throw std::runtime_error("cursor step failed: " + err);
+    return false;
+  }
+
+  row_.id   = sqlite3_column_int64(stmt, 0);
+  row_.usr  = columnText(stmt, 1);
+  row_.name = columnText(stmt, 2);
+  row_.file = columnText(stmt, 3);
+  hops_     = sqlite3_column_int(stmt, 4);
+  line_     = sqlite3_column_int(stmt, 5);
+  return true;
+}
+
+bool SqliteStore::loadFunction(std::int64_t id, SudFunction& out) const
+{
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareRead(
+    "SELECT id, usr, name, file, 0, 0 FROM sud_function WHERE id = ?;"));
+  sqlite3_bind_int64(stmt, 1, id);
 
+  FunctionCursor c(stmt);
+  if (!c.next()) return false;
+  out = c.function();
+  return true;
+}
+
+SqliteStore::FunctionCursor SqliteStore::functionsNamed(const std::string& name) const
+{
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareRead(
+    "SELECT id, usr, name, file, 0, 0 FROM sud_function WHERE name = ? ORDER BY id;"));
+  sqlite3_bind_text(stmt, 1, name.c_str(), (int)name.size(), SQLITE_TRANSIENT);
+  return FunctionCursor(stmt);
+}
+
+SqliteStore::FunctionCursor SqliteStore::calleesOf(std::int64_t id) const
+{
+  // idx_sud_call_caller (caller_id, seq) returns the rows already in order
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareRead(
+    "SELECT f.id, f.usr, f.name, f.file, 1, c.line "
+    "  FROM sud_call c JOIN sud_function f ON f.id = c.callee_id "
+    " WHERE c.caller_id = ? ORDER BY c.seq, c.rowid;"));
+  sqlite3_bind_int64(stmt, 1, id);
+  return FunctionCursor(stmt);
+}
+
+SqliteStore::FunctionCursor SqliteStore::callersOf(std::int64_t id) const
+{
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareRead(
+    "SELECT f.id, f.usr, f.name, f.file, 1, c.line "
+    "  FROM sud_call c JOIN sud_function f ON f.id = c.caller_id "
+    " WHERE c.callee_id = ? ORDER BY c.caller_id, c.seq;"));
+  sqlite3_bind_int64(stmt, 1, id);
+  return FunctionCursor(stmt);
+}
+
+SqliteStore::FunctionCursor SqliteStore::neighbourhood(std::int64_t rootId, int k, Direction dir) const
+{
+  // same bounded BFS as loadSubgraph, nodes only (shortest hop count)
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareRead(R"(
+    WITH RECURSIVE
+      down(id, depth) AS (
+        SELECT ?1, 0
+        UNION
+        SELECT c.callee_id, d.depth + 1
+          FROM down d JOIN sud_call c ON c.caller_id = d.id
+         WHERE d.depth < ?2 AND (?3 & 1)
+      ),
+      up(id, depth) AS (
+        SELECT ?1, 0
+        UNION
+        SELECT c.caller_id, u.depth + 1
+          FROM up u JOIN sud_call c ON c.callee_id = u.id
+         WHERE u.depth < ?2 AND (?3 & 2)
+      ),
+      hop(id, depth) AS (
+        SELECT id, MIN(depth) FROM (SELECT * FROM down UNION ALL SELECT * FROM up) GROUP BY id
+      )
+    SELECT f.id, f.usr, f.name, f.file, h.depth, 0
+      FROM hop h JOIN sud_function f ON f.id = h.id
+     ORDER BY h.depth, f.id;
+  )"));
+  sqlite3_bind_int64(stmt, 1, rootId);
+  sqlite3_bind_int(stmt, 2, k < 0 ? 0 : k);
+  sqlite3_bind_int(stmt, 3, directionMask(dir));
+  return FunctionCursor(stmt);
+}
+
+/* ============================================================
+ * Graph generation / SCC condensation cache
+ * ============================================================ */
+
+std::int64_t SqliteStore::metaValue(const char* key) const
+{
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareRead(
+    "SELECT value FROM sud_meta WHERE key = ?;"));
+  sqlite3_bind_text(stmt, 1, key, -1, SQLITE_STATIC);
+  std::int64_t v = -1;
+  if (sqlite3_step(stmt) == SQLITE_ROW) v = sqlite3_column_int64(stmt, 0);
+  sqlite3_finalize(stmt);
+  return v;
+}
+
+void SqliteStore::bumpGeneration()
+{
+  exec("UPDATE sud_meta SET value = value + 1 WHERE key = 'generation';");
+}
+
+std::int64_t SqliteStore::generation() const
+{
+  return metaValue("generation");
+}
+
+bool SqliteStore::loadCondensation(SudCondensation& out) const
+{
+  ScopedTimer timer("db.scc.load");
+  if (metaValue("scc_generation") != generation()) return false;
+
+  sqlite3_stmt* stmt = nullptr;
+  out = SudCondensation{};
+
+  // component ids are dense 0..n-1 (saveCondensation)
+  stmt = reinterpret_cast<sqlite3_stmt*>(prepareRead(
+    "SELECT size, recursive FROM sud_scc_component ORDER BY id;"));
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    SudComponent c;
+    c.size = (std::uint32_t)sqlite3_column_int64(stmt, 0);
+    c.recursive = sqlite3_column_int(stmt, 1) != 0;
+    out.components.push_back(c);
+  }
+  sqlite3_finalize(stmt);
+
+  stmt = reinterpret_cast<sqlite3_stmt*>(prepareRead(
+    "SELECT function_id, component FROM sud_scc ORDER BY function_id;"));
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    out.functionIds.push_back(sqlite3_column_int64(stmt, 0));
+    out.component.push_back((std::uint32_t)sqlite3_column_int64(stmt, 1));
+  }
+  sqlite3_finalize(stmt);
+
+  stmt = reinterpret_cast<sqlite3_stmt*>(prepareRead(
+    "SELECT from_component, to_component FROM sud_scc_edge;"));
+  while (sqlite3_step(stmt) == SQLITE_ROW) {
+    out.edges.push_back(SudEdge{ (std::uint32_t)sqlite3_column_int64(stmt, 0),
+                                 (std::uint32_t)sqlite3_column_int64(stmt, 1) });
+  }
+  sqlite3_finalize(stmt);
+
+  out.fingerprint = metaValue("scc_fingerprint");
+  return true;
+}
+
+void SqliteStore::saveCondensation(const SudCondensation& c)
+{
+  ScopedTimer timer("db.scc.save");
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+  Transaction txn(*this);
+
+  exec("DELETE FROM sud_scc; DELETE FROM sud_scc_component; DELETE FROM sud_scc_edge;");
+
+  sqlite3_stmt* stmt = nullptr;
+  sqlite3_prepare_v2(db, "INSERT INTO sud_scc_component (id, size, recursive) VALUES (?, ?, ?);",
+                     -1, &stmt, nullptr);
+  for (std::size_t i = 0; i < c.components.size(); ++i) {
+    sqlite3_bind_int64(stmt, 1, (std::int64_t)i);
+    sqlite3_bind_int64(stmt, 2, c.components[i].size);
+    sqlite3_bind_int(stmt, 3, c.components[i].recursive ? 1 : 0);
+    stepDone(db, stmt);
+  }
+  sqlite3_finalize(stmt);
+
+  sqlite3_prepare_v2(db, "INSERT INTO sud_scc (function_id, component) VALUES (?, ?);",
+                     -1, &stmt, nullptr);
+  for (std::size_t i = 0; i < c.functionIds.size(); ++i) {
+    sqlite3_bind_int64(stmt, 1, c.functionIds[i]);
+    sqlite3_bind_int64(stmt, 2, c.component[i]);
+    stepDone(db, stmt);
+  }
+  sqlite3_finalize(stmt);
+
+  sqlite3_prepare_v2(db, "INSERT INTO sud_scc_edge (from_component, to_component) VALUES (?, ?);",
+                     -1, &stmt, nullptr);
+  for (const auto& e : c.edges) {
+    sqlite3_bind_int64(stmt, 1, e.caller);
+    sqlite3_bind_int64(stmt, 2, e.callee);
+    stepDone(db, stmt);
+  }
   sqlite3_finalize(stmt);
+
+  exec("INSERT INTO sud_meta (key, value) "
+       "SELECT 'scc_generation', value FROM sud_meta WHERE key = 'generation' "
+       "ON CONFLICT(key) DO UPDATE SET value = excluded.value;");
+  exec("INSERT INTO sud_meta (key, value) VALUES ('scc_fingerprint', " + std::to_string(c.fingerprint) + ") "
+       "ON CONFLICT(key) DO UPDATE SET value = excluded.value;");
+  txn.commit();
+}
+
+std::int64_t SqliteStore::condensationFingerprint() const
+{
+  return metaValue("scc_fingerprint");
+}
+
+/* ============================================================
+ * Reachability index
+ * ============================================================ */
+
+std::int64_t SqliteStore::reachGeneration() const
+{
+  // only valid together with the condensation it was built from
+  const std::int64_t reach = metaValue("reach_generation");
+  return reach == metaValue("scc_generation") ? reach : -1;
+}
+
+void SqliteStore::saveReachIndex(const SudReachIndex& r)
+{
+  ScopedTimer timer("db.reach.save");
+  sqlite3* db = reinterpret_cast<sqlite3*>(db_);
+  Transaction txn(*this);
+
+  exec("DELETE FROM sud_reach_component; DELETE FROM sud_reach_interval;");
+
+  sqlite3_stmt* component = nullptr;
+  sqlite3_stmt* interval = nullptr;
+  sqlite3_prepare_v2(db, "INSERT INTO sud_reach_component (id, post, exact) VALUES (?, ?, ?);",
+                     -1, &component, nullptr);
+  sqlite3_prepare_v2(db, "INSERT INTO sud_reach_interval (component, lo, hi, exact) VALUES (?, ?, ?, ?);",
+                     -1, &interval, nullptr);
+
+  for (std::size_t c = 0; c < r.post.size(); ++c) {
+    bool exact = true;
+    for (std::uint32_t k = r.offsets[c]; k < r.offsets[c + 1]; ++k) {
+      const SudInterval& iv = r.intervals[k];
+      exact = exact && iv.exact;
+      sqlite3_bind_int64(interval, 1, (std::int64_t)c);
+      sqlite3_bind_int64(interval, 2, iv.lo);
+      sqlite3_bind_int64(interval, 3, iv.hi);
+      sqlite3_bind_int(interval, 4, iv.exact ? 1 : 0);
+      stepDone(db, interval);
+    }
+    sqlite3_bind_int64(component, 1, (std::int64_t)c);
+    sqlite3_bind_int64(component, 2, r.post[c]);
+    sqlite3_bind_int(component, 3, exact ? 1 : 0);
+    stepDone(db, component);
+  }
+  sqlite3_finalize(component);
+  sqlite3_finalize(interval);
+
+  // stamped with the condensation's generation, not the current one:
+  // an index built over a stale sud_scc is stale as well
+  exec("INSERT INTO sud_meta (key, value) "
+       "SELECT 'reach_generation', value FROM sud_meta WHERE key = 'scc_generation' "
+       "ON CONFLICT(key) DO UPDATE SET value = excluded.value;");
+  txn.commit();
+}
+
+void SqliteStore::restampReachIndex()
+{
+  Transaction txn(*this);
+  exec("UPDATE sud_meta SET value = (SELECT value FROM sud_meta WHERE key = 'generation') "
+       "WHERE key IN ('scc_generation', 'reach_generation');");
+  txn.commit();
 }
 
+bool SqliteStore::callsTransitively(std::int64_t callerId, std::int64_t calleeId) const
+{
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareRead(R"(
+    SELECT a.component, b.component, r.post, k.recursive
+      FROM sud_scc a
+      JOIN sud_scc b ON b.function_id = ?2
+      JOIN sud_reach_component r ON r.id = a.component
+      JOIN sud_scc_component k ON k.id = a.component
+     WHERE a.function_id = ?1;
+  )"));
+  sqlite3_bind_int64(stmt, 1, callerId);
+  sqlite3_bind_int64(stmt, 2, calleeId);
+  const bool found = sqlite3_step(stmt) == SQLITE_ROW;
+  const std::int64_t from = found ? sqlite3_column_int64(stmt, 0) : -1;
+  const std::int64_t to = found ? sqlite3_column_int64(stmt, 1) : -1;
+  const std::int64_t post = found ? sqlite3_column_int64(stmt, 2) : -1;
+  const bool recursive = found && sqlite3_column_int(stmt, 3) != 0;
+  sqlite3_finalize(stmt);
+
+  if (!found) return false;
+  if (from == to) return recursive;
 
+  // the interval of `c` that could hold the caller's post number:
+  // 0 none (c is not reached from the caller), 1 exact, 2 approximate
+  auto* hit = reinterpret_cast<sqlite3_stmt*>(prepareRead(
+    "SELECT hi >= ?2, exact FROM sud_reach_interval "
+    "WHERE component = ?1 AND lo <= ?2 ORDER BY lo DESC LIMIT 1;"));
+  auto* up = reinterpret_cast<sqlite3_stmt*>(prepareRead(
+    "SELECT from_component FROM sud_scc_edge WHERE to_component = ?;"));
+  auto lookup = [&](std::int64_t c) {
+    sqlite3_bind_int64(hit, 1, c);
+    sqlite3_bind_int64(hit, 2, post);
+    int h = 0;
+    if (sqlite3_step(hit) == SQLITE_ROW && sqlite3_column_int(hit, 0)) {
+      h = sqlite3_column_int(hit, 1) ? 1 : 2;
+    }
+    sqlite3_reset(hit);
+    return h;
+  };
+
+  // usually decided by the callee's own label; an approximate hit walks
+  // up through the callers whose labels still admit the caller
+  bool yes = false;
+  std::vector<std::int64_t> stack = { to };
+  std::unordered_set<std::int64_t> seen = { to };
+  while (!stack.empty() && !yes) {
+    const std::int64_t c = stack.back();
+    stack.pop_back();
+
+    const int h = lookup(c);
+    if (h == 0) continue;
+    if (h == 1 || c == from) {
+      yes = true;
+      break;
+    }
+
+    sqlite3_bind_int64(up, 1, c);
+    while (sqlite3_step(up) == SQLITE_ROW) {
+      const std::int64_t u = sqlite3_column_int64(up, 0);
+      if (seen.insert(u).second) stack.push_back(u);
+    }
+    sqlite3_reset(up);
+  }
+
+  sqlite3_finalize(hit);
+  sqlite3_finalize(up);
+  return yes;
+}
+
+SqliteStore::FunctionCursor SqliteStore::transitiveCallers(std::int64_t id, bool entryPointsOnly) const
+{
+  // exact label: its post-order ranges are the callers, nothing walked;
+  // capped label: the condensation is walked instead (sud_scc_edge), still
+  // cheaper than sud_call since cycles and repeated calls are folded.
+  // The callee's own component counts only if it is recursive.
+  // CROSS JOIN pins the join order: never a scan of the interval /
+  // function tables.
+  auto* stmt = reinterpret_cast<sqlite3_stmt*>(prepareRead(R"(
+    WITH RECURSIVE
+      x(c, recursive, exact) AS (
+        SELECT s.component, k.recursive, r.exact
+          FROM sud_scc s
+          JOIN sud_scc_component k ON k.id = s.component
+          JOIN sud_reach_component r ON r.id = s.component
+         WHERE s.function_id = ?1
+      ),
+      walk(c, capped) AS (
+        SELECT c, NOT exact FROM x
+        UNION
+        SELECT e.from_component, 1
+          FROM walk
+          CROSS JOIN sud_scc_edge e ON e.to_component = walk.c
+         WHERE walk.capped
+      ),
+      comps(c) AS (
+        SELECT c FROM walk
+        UNION
+        SELECT r.id
+          FROM x
+          CROSS JOIN sud_reach_interval i ON i.component = x.c
+          CROSS JOIN sud_reach_component r ON r.post BETWEEN i.lo AND i.hi
+         WHERE x.exact
+      )
+    SELECT f.id, f.usr, f.name, f.file, 0, 0
+      FROM x
+      CROSS JOIN comps
+      CROSS JOIN sud_scc s ON s.component = comps.c
+      CROSS JOIN sud_function f ON f.id = s.function_id
+     WHERE (comps.c <> x.c OR x.recursive)
+       AND (NOT ?2 OR NOT EXISTS (SELECT 1 FROM sud_call c WHERE c.callee_id = f.id))
+     ORDER BY f.name, f.id;
+  )"));
+  sqlite3_bind_int64(stmt, 1, id);
+  sqlite3_bind_int(stmt, 2, entryPointsOnly ? 1 : 0);
+  return FunctionCursor(stmt);
+}
@@ -1,6 +1,11 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <string>
+#include <unordered_map>
 #include "ir/sud/SudModel.h"
 
 class SqliteStore {
@@ -8,16 +13,241 @@ public:
   explicit SqliteStore(const std::string& dbPath);
   ~SqliteStore();
 
-  /* schema */
+  SqliteStore(const SqliteStore&) = delete;
+  SqliteStore& operator=(const SqliteStore&) = delete;
+
+  /* schema (creates or migrates to kSchemaVersion) */
+  static constexpr int kSchemaVersion = 9;
   void initSchema();
+  int schemaVersion() const;
+
+  /*
+   * Explicit transaction scope.
+   * - outermost scope: BEGIN / COMMIT, nested scopes: SAVEPOINT
+   * - rolled back on destruction unless commit() was called
+   */
+  class Transaction {
+  public:
+    explicit Transaction(SqliteStore& store);
+    ~Transaction();
+
+    Transaction(const Transaction&) = delete;
+    Transaction& operator=(const Transaction&) = delete;
+
+    void commit();
+
+  private:
+    SqliteStore& store_;
+    int depth_;
+    bool done_ = false;
+  };
+
+  /*
+   * Indexing session: journal_mode=WAL + synchronous=NORMAL while alive,
+   * previous (durable) settings restored on destruction.
+   */
+  class IndexingSession {
+  public:
+    explicit IndexingSession(SqliteStore& store);
+    ~IndexingSession();
+
+    IndexingSession(const IndexingSession&) = delete;
+    IndexingSession& operator=(const IndexingSession&) = delete;
+
+  private:
+    SqliteStore& store_;
+    std::string journalMode_;
+    std::string synchronous_;
+  };
+
+  /*
+   * Rows per implicit transaction when insert*() is called outside an
+   * explicit Transaction (inside one, the caller's scope decides).
+   */
+  void setBatchSize(std::size_t rows);
+  std::size_t batchSize() const { return batchSize_; }
 
   /* write (SudModel 단위) */
   void insertFunctions(const std::vector<SudFunction>& funcs);
   void insertCalls(const std::vector<SudCall>& calls);
 
+  /*
+   * incremental indexing (per source file)
+   * - replaceFile: atomically swaps the file's functions/calls/pointer facts, hash and deps
+   * - removeFile : drops a file that no longer exists (false if it was not tracked)
+   * - pruneStubs : drops stub functions no call refers to any more
+   */
+  std::unordered_map<std::string, SudFile> loadFiles() const;  // path -> file (+ deps)
+  void replaceFile(const SudFile& file,
+                   const std::vector<SudFunction>& funcs,
+                   const std::vector<SudCall>& calls,
+                   const std::vector<SudPtrFact>& facts = {});
+  bool removeFile(const std::string& path);
+  void pruneStubs();
+
+  /*
+   * function pointer facts of every file, and the indirect call edges
+   * resolved from them (graph/PointsTo.h: refreshIndirectCalls)
+   * - replaceIndirectCalls: swaps every kind = Indirect sud_call row
+   *   (not owned by a file: facts of one file change other files' targets)
+   */
+  std::vector<SudPtrFact> loadPointerFacts() const;
+  void replaceIndirectCalls(const std::vector<SudCall>& calls);
+
+  /*
+   * graph generation: bumped by every write to functions / calls,
+   * derived caches (condensation, ...) record the generation they
+   * were built from and are stale once it moves on
+   */
+  std::int64_t generation() const;
+
   /* read */
   SudModel loadSudModel() const;
 
+  /*
+   * SCC condensation cache (sud_scc*)
+   * - loadCondensation: false if never built or stale
+   * - saveCondensation: replaces the cache, stamped with generation()
+   *   and the condensation's fingerprint
+   * - condensationFingerprint: of the stored cache (current or not), -1 if none
+   */
+  bool loadCondensation(SudCondensation& out) const;
+  void saveCondensation(const SudCondensation& c);
+  std::int64_t condensationFingerprint() const;
+
+  /*
+   * bounded subgraph around one function, traversed inside SQLite
+   * (recursive CTE over the caller/callee indexes).
+   * functions[0] is the root; edges are deduplicated.
+   */
+  enum class Direction { Callees, Callers, Both };
+  SudModel loadSubgraph(std::int64_t rootId, int depth, Direction dir) const;
+
+  // USR or function name -> sud_function.id (0 if absent)
+  std::int64_t findFunctionId(const std::string& usrOrName) const;
+
+  /*
+   * Forward-only row cursor over sud_function rows (one prepared
+   * statement, rows decoded as they are stepped; nothing is buffered).
+   * Must not outlive the store.
+   *
+   *   for (const SudFunction& f : store.calleesOf(id)) ...
+   *   auto c = store.neighbourhood(id, 2, Direction::Both);
+   *   while (c.next()) use(c.function(), c.hops());
+   */
+  class FunctionCursor {
+  public:
+    FunctionCursor(FunctionCursor&& other) noexcept;
+    FunctionCursor& operator=(FunctionCursor&& other) noexcept;
+    ~FunctionCursor();
+
+    FunctionCursor(const FunctionCursor&) = delete;
+    FunctionCursor& operator=(const FunctionCursor&) = delete;
+
+    // advance to the next row; false (and the statement released) at the end
+    bool next();
+
+    const SudFunction& function() const { return row_; }
+    // distance from the root (neighbourhood), 1 for callees/callers, 0 otherwise
+    int hops() const { return hops_; }
+    // call-site line (calleesOf / callersOf), 0 otherwise
+    int line() const { return line_; }
+
+    class iterator {
+    public:
+      using iterator_category = std::input_iterator_tag;
+      using value_type = SudFunction;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const SudFunction*;
+      using reference = const SudFunction&;
+
+      explicit iterator(FunctionCursor* cursor) : cursor_(cursor) {}
+      reference operator*() const { return cursor_->function(); }
+      pointer operator->() const { return &cursor_->function(); }
+      iterator& operator++() {
+        if (!cursor_->next()) cursor_ = nullptr;
+        return *this;
+      }
+      bool operator==(const iterator& o) const { return cursor_ == o.cursor_; }
+      bool operator!=(const iterator& o) const { return cursor_ != o.cursor_; }
+
+    private:
+      FunctionCursor* cursor_;
+    };
+
+    // single pass: begin() steps to the first row
+    iterator begin() { return iterator(next() ? this : nullptr); }
+    iterator end() { return iterator(nullptr); }
+
+  private:
+    friend class SqliteStore;
+    explicit FunctionCursor(void* stmt) : stmt_(stmt) {}
+
+    void* stmt_;   // sqlite3_stmt*, columns: id, usr, name, file, hops, line
+    SudFunction row_;
+    int hops_ = 0;
+    int line_ = 0;
+  };
+
+  /* scoped reads: only the rows asked for are visited */
+  bool loadFunction(std::int64_t id, SudFunction& out) const;
+  FunctionCursor functionsNamed(const std::string& name) const;    // id order
+  // one row per call site, in call-site order (seq); repeats kept
+  FunctionCursor calleesOf(std::int64_t id) const;
+  FunctionCursor callersOf(std::int64_t id) const;
+  // every function within k hops (root included, hops 0), nearest first
+  FunctionCursor neighbourhood(std::int64_t rootId, int k, Direction dir) const;
+
+  /*
+   * reachability index (sud_reach*), built over the stored condensation
+   * (graph/Reachability.h: refreshReachIndex keeps both current)
+   * - reachGeneration: generation it was built for, -1 if never built
+   * - queries below assume reachGeneration() == generation()
+   */
+  std::int64_t reachGeneration() const;
+  void saveReachIndex(const SudReachIndex& r);
+  // stored condensation + index describe the current graph too: stamp
+  // both with generation() without rewriting them
+  void restampReachIndex();
+  // callerId calls calleeId directly or transitively (label lookups; a short
+  // pruned walk over sud_scc_edge only where a capped label is approximate)
+  bool callsTransitively(std::int64_t callerId, std::int64_t calleeId) const;
+  // every direct or transitive caller, name order; entryPointsOnly: those nothing calls
+  FunctionCursor transitiveCallers(std::int64_t id, bool entryPointsOnly = false) const;
+
 private:
+  void exec(const std::string& sql);
+  std::string queryText(const char* sql) const;
+  void* prepareRead(const char* sql) const;
+  void* prepareCached(void*& slot, const char* sql);
+  void writeBatched(std::size_t rows, const std::function<void(std::size_t)>& writeRow);
+  void migrateV1toV2();
+  void bumpGeneration();
+  std::int64_t metaValue(const char* key) const;   // -1 if absent
+
+  // fileId 0 -> not owned by an indexed file (NULL)
+  void writeFunctions(const std::vector<SudFunction>& funcs, std::int64_t fileId);
+  void writeCalls(const std::vector<SudCall>& calls, std::int64_t fileId);
+  void writePointerFacts(const std::vector<SudPtrFact>& facts, std::int64_t fileId);
+  void writeFileDeps(const std::vector<SudFileDep>& deps, std::int64_t fileId);
+  void dropFileContent(std::int64_t fileId);
+
+  // USR -> sud_function.id, inserting a stub row for unknown USRs
+  std::int64_t internUsr(const std::string& usr, const std::string& name);
+
   void* db_;
+
+  /* prepared statements reused across batches (sqlite3_stmt*) */
+  void* insertFunctionStmt_ = nullptr;
+  void* insertCallStmt_ = nullptr;
+  void* insertFactStmt_ = nullptr;
+  void* insertDepStmt_ = nullptr;
+  void* internStmt_ = nullptr;
+  void* lookupIdStmt_ = nullptr;
+
+  /* USR intern cache (cleared on rollback) */
+  std::unordered_map<std::string, std::int64_t> usrIds_;
+
+  std::size_t batchSize_ = 10000;
+  int txnDepth_ = 0;
 };
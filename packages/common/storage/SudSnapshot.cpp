@@ -0,0 +1,436 @@
+#include "storage/SudSnapshot.h"
+#include "storage/SqliteStore.h"
+#include "profile/Profiler.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#if defined(_WIN32)
+#  define WIN32_LEAN_AND_MEAN
+#  include <windows.h>
+#else
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+/* ============================================================
+ * File layout (native byte order, checked through kEndianTag)
+ * ============================================================ */
+
+static constexpr char kMagic[8] = { 'S', 'U', 'D', 'S', 'N', 'A', 'P', '\0' };
+static constexpr std::uint32_t kEndianTag = 0x01020304;
+
+struct SudSnapshot::Header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t endian;
+  std::int64_t generation;
+  std::uint64_t fileSize;
+  std::uint32_t functionCount;
+  std::uint32_t edgeCount;
+
+  // section offsets: bytes from the start of the file, 8-byte aligned
+  std::uint64_t strings;      // char[stringsSize], NUL after every string
+  std::uint64_t stringsSize;
+  std::uint64_t functions;    // FunctionRecord[functionCount]
+  std::uint64_t fwdOffsets;   // uint32[functionCount + 1]
+  std::uint64_t fwdTargets;   // uint32[edgeCount]
+  std::uint64_t fwdLines;     // uint32[edgeCount], parallel to fwdTargets
+  std::uint64_t revOffsets;   // uint32[functionCount + 1]
+  std::uint64_t revTargets;   // uint32[edgeCount]
+  std::uint64_t byUsr;        // uint32[functionCount], node ids by usr
+  std::uint64_t byName;       // uint32[functionCount], node ids by (name, stub, id)
+};
+
+struct SudSnapshot::FunctionRecord {
+  std::int64_t id;
+  std::uint32_t usr, usrLength;
+  std::uint32_t name, nameLength;
+  std::uint32_t file, fileLength;
+};
+
+/* ============================================================
+ * Export
+ * ============================================================ */
+
+namespace {
+
+class SnapshotBuffer {
+public:
+  // appends at the next 8-byte boundary, returns the section offset
+  std::uint64_t append(const void* data, std::size_t size) {
+    bytes_.resize((bytes_.size() + 7) & ~std::size_t(7), '\0');
+    const std::uint64_t offset = bytes_.size();
+    bytes_.insert(bytes_.end(), (const char*)data, (const char*)data + size);
+    return offset;
+  }
+
+  template <class T>
+  std::uint64_t append(const std::vector<T>& v) { return append(v.data(), v.size() * sizeof(T)); }
+
+  std::vector<char>& bytes() { return bytes_; }
+
+private:
+  std::vector<char> bytes_;
+};
+
+// stable counting sort into CSR (call-site order per node kept)
+void buildCsr(const SudModel& m, bool reverse,
+              std::vector<std::uint32_t>& offsets,
+              std::vector<std::uint32_t>& targets,
+              std::vector<std::uint32_t>* lines)
+{
+  const std::size_t n = m.functions.size();
+  offsets.assign(n + 1, 0);
+  for (const auto& e : m.edges) ++offsets[(reverse ? e.callee : e.caller) + 1];
+  for (std::size_t i = 0; i < n; ++i) offsets[i + 1] += offsets[i];
+
+  targets.resize(m.edges.size());
+  if (lines) lines->resize(m.edges.size());
+  std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+  for (const auto& e : m.edges) {
+    const std::uint32_t slot = cursor[reverse ? e.callee : e.caller]++;
+    targets[slot] = reverse ? e.caller : e.callee;
+    if (lines) (*lines)[slot] = e.line;
+  }
+}
+
+} // namespace
+
+void SudSnapshot::write(const SudModel& model, std::int64_t generation, const std::string& path)
+{
+  ScopedTimer timer("snapshot.write");
+  const std::size_t n = model.functions.size();
+
+  /* ---- string pool (deduplicated: files repeat per function) ---- */
+  std::vector<char> pool;
+  std::unordered_map<std::string_view, std::uint32_t> pooled;
+  auto intern = [&](const std::string& s) {
+    auto it = pooled.find(s);
+    if (it != pooled.end()) return it->second;
+    if (pool.size() + s.size() + 1 > UINT32_MAX) {
+      throw std::runtime_error("snapshot string pool exceeds 4 GiB: " + path);
+    }
+    const auto offset = (std::uint32_t)pool.size();
+    pool.insert(pool.end(), s.begin(), s.end());
+    pool.push_back('\0');
+    pooled.emplace(s, offset);
+    return offset;
+  };
+
+  std::vector<FunctionRecord> records(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const SudFunction& f = model.functions[i];
+    records[i] = FunctionRecord{ f.id,
+                                 intern(f.usr), (std::uint32_t)f.usr.size(),
+                                 intern(f.name), (std::uint32_t)f.name.size(),
+                                 intern(f.file), (std::uint32_t)f.file.size() };
+  }
+
+  /* ---- adjacency ---- */
+  std::vector<std::uint32_t> fwdOffsets, fwdTargets, fwdLines, revOffsets, revTargets;
+  buildCsr(model, /*reverse*/false, fwdOffsets, fwdTargets, &fwdLines);
+  buildCsr(model, /*reverse*/true, revOffsets, revTargets, nullptr);
+
+  /* ---- sorted lookup indexes ---- */
+  std::vector<std::uint32_t> byUsr(n), byName(n);
+  std::iota(byUsr.begin(), byUsr.end(), 0u);
+  std::iota(byName.begin(), byName.end(), 0u);
+  const auto& fs = model.functions;
+  std::sort(byUsr.begin(), byUsr.end(), [&](std::uint32_t a, std::uint32_t b) {
+    return fs[a].usr < fs[b].usr;
+  });
+  std::sort(byName.begin(), byName.end(), [&](std::uint32_t a, std::uint32_t b) {
+    if (fs[a].name != fs[b].name) return fs[a].name < fs[b].name;
+    if (fs[a].file.empty() != fs[b].file.empty()) return !fs[a].file.empty();
+    return fs[a].id < fs[b].id;
+  });
+
+  /* ---- assemble ---- */
+  Header h{};
+  std::memcpy(h.magic, kMagic, sizeof(kMagic));
+  h.version = kVersion;
+  h.endian = kEndianTag;
+  h.generation = generation;
+  h.functionCount = (std::uint32_t)n;
+  h.edgeCount = (std::uint32_t)model.edges.size();
+
+  SnapshotBuffer out;
+  out.append(&h, sizeof(h));   // patched below
+  h.strings = out.append(pool);
+  h.stringsSize = pool.size();
+  h.functions = out.append(records);
+  h.fwdOffsets = out.append(fwdOffsets);
+  h.fwdTargets = out.append(fwdTargets);
+  h.fwdLines = out.append(fwdLines);
+  h.revOffsets = out.append(revOffsets);
+  h.revTargets = out.append(revTargets);
+  h.byUsr = out.append(byUsr);
+  h.byName = out.append(byName);
+  h.fileSize = out.bytes().size();
+  std::memcpy(out.bytes().data(), &h, sizeof(h));
+
+  // readers mapping the old file keep it; a reader opening `path`
+  // never sees a partial one
+  const std::string tmp = path + ".tmp" +
+    std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+  {
+    std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+    f.write(out.bytes().data(), (std::streamsize)out.bytes().size());
+    f.close();
+    if (!f) {
+      std::error_code ec;
+      std::filesystem::remove(tmp, ec);
+      throw std::runtime_error("failed to write snapshot: " + tmp);
+    }
+  }
+  std::error_code ec;
+  std::filesystem::rename(tmp, path, ec);
+  if (ec) {
+    std::filesystem::remove(tmp, ec);
+    throw std::runtime_error("failed to replace snapshot: " + path);
+  }
+
+  Profiler::instance().count("snapshot.bytes", (std::int64_t)h.fileSize);
+}
+
+std::int64_t SudSnapshot::peekGeneration(const std::string& path)
+{
+  std::ifstream f(path, std::ios::binary);
+  Header h{};
+  if (!f.read(reinterpret_cast<char*>(&h), sizeof(h))) return -1;
+  if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0) return -1;
+  if (h.version != kVersion || h.endian != kEndianTag) return -1;
+  return h.generation;
+}
+
+std::unique_ptr<SudSnapshot> SudSnapshot::openCurrent(const SqliteStore& db, const std::string& path,
+                                                      bool* rebuilt)
+{
+  const std::int64_t generation = db.generation();
+  const bool stale = peekGeneration(path) != generation;
+  if (stale) write(db.loadSudModel(), generation, path);
+  if (rebuilt) *rebuilt = stale;
+  return std::make_unique<SudSnapshot>(path);
+}
+
+/* ============================================================
+ * Mapping
+ * ============================================================ */
+
+SudSnapshot::SudSnapshot(const std::string& path)
+{
+  static_assert(sizeof(Header) == 120, "snapshot header layout");
+  static_assert(sizeof(FunctionRecord) == 32, "snapshot function record layout");
+  ScopedTimer timer("snapshot.map");
+
+#if defined(_WIN32)
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("failed to open snapshot: " + path);
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    CloseHandle(file);
+    throw std::runtime_error("failed to open snapshot: " + path);
+  }
+  HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  CloseHandle(file);
+  const void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+  if (!view) {
+    if (mapping) CloseHandle(mapping);
+    throw std::runtime_error("failed to map snapshot: " + path);
+  }
+  base_ = static_cast<const char*>(view);
+  size_ = (std::size_t)size.QuadPart;
+  mapping_ = mapping;
+#else
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw std::runtime_error("failed to open snapshot: " + path);
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+    ::close(fd);
+    throw std::runtime_error("failed to open snapshot: " + path);
+  }
+  void* view = ::mmap(nullptr, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED) throw std::runtime_error("failed to map snapshot: " + path);
+  base_ = static_cast<const char*>(view);
+  size_ = (std::size_t)st.st_size;
+#endif
+
+  /* ---- header and section bounds (contents are trusted: write() made them) ---- */
+  auto fail = [&](const char* why) {
+    unmap();   // no destructor run for a throwing constructor
+    throw std::runtime_error(std::string("invalid snapshot (") + why + "): " + path);
+  };
+  if (size_ < sizeof(Header)) fail("truncated");
+
+  const Header& h = header();
+  if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0) fail("magic");
+  if (h.endian != kEndianTag) fail("byte order");
+  if (h.version != kVersion) fail("version");
+  if (h.fileSize != size_) fail("size");
+
+  const std::uint64_t n = h.functionCount;
+  const std::uint64_t m = h.edgeCount;
+  const struct { std::uint64_t offset, bytes; } sections[] = {
+    { h.strings, h.stringsSize },
+    { h.functions, n * sizeof(FunctionRecord) },
+    { h.fwdOffsets, (n + 1) * 4 }, { h.fwdTargets, m * 4 }, { h.fwdLines, m * 4 },
+    { h.revOffsets, (n + 1) * 4 }, { h.revTargets, m * 4 },
+    { h.byUsr, n * 4 }, { h.byName, n * 4 },
+  };
+  for (const auto& s : sections) {
+    if (s.offset % 8 != 0 || s.offset < sizeof(Header) || s.offset > size_ || s.bytes > size_ - s.offset)
+      fail("section bounds");
+  }
+  if (section<std::uint32_t>(h.fwdOffsets)[n] != m || section<std::uint32_t>(h.revOffsets)[n] != m)
+    fail("edge count");
+}
+
+SudSnapshot::~SudSnapshot()
+{
+  unmap();
+}
+
+void SudSnapshot::unmap()
+{
+  if (!base_) return;
+#if defined(_WIN32)
+  UnmapViewOfFile(base_);
+  CloseHandle(static_cast<HANDLE>(mapping_));
+#else
+  ::munmap(const_cast<char*>(base_), size_);
+#endif
+  base_ = nullptr;
+}
+
+/* ============================================================
+ * Queries (zero-copy)
+ * ============================================================ */
+
+const SudSnapshot::Header& SudSnapshot::header() const
+{
+  return *reinterpret_cast<const Header*>(base_);
+}
+
+template <class T>
+const T* SudSnapshot::section(std::uint64_t offset) const
+{
+  return reinterpret_cast<const T*>(base_ + offset);
+}
+
+const SudSnapshot::FunctionRecord& SudSnapshot::record(NodeId n) const
+{
+  return section<FunctionRecord>(header().functions)[n];
+}
+
+std::string_view SudSnapshot::str(std::uint32_t offset, std::uint32_t length) const
+{
+  return std::string_view(base_ + header().strings + offset, length);
+}
+
+std::int64_t SudSnapshot::generation() const { return header().generation; }
+std::size_t SudSnapshot::nodeCount() const { return header().functionCount; }
+std::size_t SudSnapshot::edgeCount() const { return header().edgeCount; }
+
+std::int64_t SudSnapshot::id(NodeId n) const { return record(n).id; }
+
+std::string_view SudSnapshot::usr(NodeId n) const
+{
+  const FunctionRecord& r = record(n);
+  return str(r.usr, r.usrLength);
+}
+
+std::string_view SudSnapshot::name(NodeId n) const
+{
+  const FunctionRecord& r = record(n);
+  return str(r.name, r.nameLength);
+}
+
+std::string_view SudSnapshot::file(NodeId n) const
+{
+  const FunctionRecord& r = record(n);
+  return str(r.file, r.fileLength);
+}
+
+SudSnapshot::NodeId SudSnapshot::findById(std::int64_t id) const
+{
+  // the function table is in id order
+  const FunctionRecord* first = section<FunctionRecord>(header().functions);
+  const FunctionRecord* last = first + nodeCount();
+  const FunctionRecord* it = std::lower_bound(first, last, id, [](const FunctionRecord& r, std::int64_t key) {
+    return r.id < key;
+  });
+  return (it != last && it->id == id) ? (NodeId)(it - first) : kNone;
+}
+
+SudSnapshot::NodeId SudSnapshot::findByUsr(std::string_view usr) const
+{
+  const std::uint32_t* first = section<std::uint32_t>(header().byUsr);
+  const std::uint32_t* last = first + nodeCount();
+  const std::uint32_t* it = std::lower_bound(first, last, usr, [&](std::uint32_t n, std::string_view key) {
+    return this->usr(n) < key;
+  });
+  return (it != last && this->usr(*it) == usr) ? *it : kNone;
+}
+
+SudSnapshot::NodeId SudSnapshot::findByName(std::string_view name) const
+{
+  const std::uint32_t* first = section<std::uint32_t>(header().byName);
+  const std::uint32_t* last = first + nodeCount();
+  const std::uint32_t* it = std::lower_bound(first, last, name, [&](std::uint32_t n, std::string_view key) {
+    return this->name(n) < key;
+  });
+  return (it != last && this->name(*it) == name) ? *it : kNone;
+}
+
+std::size_t SudSnapshot::countNamed(std::string_view name) const
+{
+  const std::uint32_t* first = section<std::uint32_t>(header().byName);
+  const std::uint32_t* last = first + nodeCount();
+  const std::uint32_t* lo = std::lower_bound(first, last, name, [&](std::uint32_t n, std::string_view key) {
+    return this->name(n) < key;
+  });
+  const std::uint32_t* hi = std::upper_bound(lo, last, name, [&](std::string_view key, std::uint32_t n) {
+    return key < this->name(n);
+  });
+  return (std::size_t)(hi - lo);
+}
+
+SudSnapshot::NodeId SudSnapshot::resolve(std::string_view usrOrName) const
+{
+  NodeId n = findByUsr(usrOrName);
+  return n != kNone ? n : findByName(usrOrName);
+}
+
+SudSnapshot::Range SudSnapshot::callees(NodeId n) const
+{
+  const Header& h = header();
+  const std::uint32_t* offsets = section<std::uint32_t>(h.fwdOffsets);
+  const NodeId* base = section<NodeId>(h.fwdTargets);
+  return Range{ base + offsets[n], base + offsets[n + 1] };
+}
+
+SudSnapshot::Range SudSnapshot::callers(NodeId n) const
+{
+  const Header& h = header();
+  const std::uint32_t* offsets = section<std::uint32_t>(h.revOffsets);
+  const NodeId* base = section<NodeId>(h.revTargets);
+  return Range{ base + offsets[n], base + offsets[n + 1] };
+}
+
+const std::uint32_t* SudSnapshot::calleeLines(NodeId n) const
+{
+  const Header& h = header();
+  return section<std::uint32_t>(h.fwdLines) + section<std::uint32_t>(h.fwdOffsets)[n];
+}
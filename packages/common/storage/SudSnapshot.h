@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "graph/SudGraph.h"
+#include "ir/sud/SudModel.h"
+
+class SqliteStore;
+
+/*
+ * ============================================================
+ * Binary snapshot of the SUD model (read-optimised cache)
+ * - one file: header, string pool, function table, forward /
+ *   reverse CSR edges (call-site order and lines kept), USR and
+ *   name indexes sorted for binary search
+ * - position independent: sections are addressed by file offset,
+ *   so the file is mmap'ed and served in place, strings as
+ *   std::string_view into the pool (no per-function allocation)
+ * - SqliteStore stays the source of truth: the header records
+ *   the graph generation the snapshot was exported from
+ * - node ids = function order by sud_function.id (as SudGraph)
+ * ============================================================
+ */
+class SudSnapshot {
+public:
+  using NodeId = SudGraph::NodeId;
+  using Range = SudGraph::Range;
+  static constexpr NodeId kNone = SudGraph::kNone;
+
+  static constexpr std::uint32_t kVersion = 1;
+
+  // written to a temporary file and renamed over `path`
+  static void write(const SudModel& model, std::int64_t generation, const std::string& path);
+
+  /*
+   * Snapshot of the DB's current generation: `path` is mapped if it
+   * was exported from db.generation(), otherwise re-exported first.
+   * rebuilt (optional) tells which of the two happened.
+   */
+  static std::unique_ptr<SudSnapshot> openCurrent(const SqliteStore& db, const std::string& path,
+                                                  bool* rebuilt = nullptr);
+
+  // mmap + header / section checks; throws std::runtime_error
+  explicit SudSnapshot(const std::string& path);
+  ~SudSnapshot();
+
+  SudSnapshot(const SudSnapshot&) = delete;
+  SudSnapshot& operator=(const SudSnapshot&) = delete;
+
+  // generation of a snapshot file without mapping it (-1 if missing / not a snapshot)
+  static std::int64_t peekGeneration(const std::string& path);
+
+  std::int64_t generation() const;
+  std::size_t nodeCount() const;
+  std::size_t edgeCount() const;
+  std::size_t sizeBytes() const { return size_; }
+
+  /* function table (views into the mapping, valid while *this lives) */
+  std::int64_t id(NodeId n) const;             // sud_function.id
+  std::string_view usr(NodeId n) const;
+  std::string_view name(NodeId n) const;
+  std::string_view file(NodeId n) const;      // "" = stub
+
+  /* lookups (kNone if absent), O(log n) */
+  NodeId findById(std::int64_t id) const;
+  NodeId findByUsr(std::string_view usr) const;
+  NodeId findByName(std::string_view name) const;   // defined before stub, then lowest id
+  NodeId resolve(std::string_view usrOrName) const; // USR first, then name (as findFunctionId)
+  std::size_t countNamed(std::string_view name) const;
+
+  /* adjacency, call-site order; calleeLines(n)[i] is the line of callees(n)[i] */
+  Range callees(NodeId n) const;
+  Range callers(NodeId n) const;
+  const std::uint32_t* calleeLines(NodeId n) const;
+
+private:
+  struct Header;
+  struct FunctionRecord;
+
+  void unmap();
+  const Header& header() const;
+  const FunctionRecord& record(NodeId n) const;
+  template <class T> const T* section(std::uint64_t offset) const;
+  std::string_view str(std::uint32_t offset, std::uint32_t length) const;
+
+  const char* base_ = nullptr;
+  std::size_t size_ = 0;
+  void* mapping_ = nullptr;   // Windows file mapping handle
+};
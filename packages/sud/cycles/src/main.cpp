@@ -0,0 +1,228 @@
+#include "storage/SqliteStore.h"
+#include "graph/SudGraph.h"
+#include "graph/Scc.h"
+#include "puml/PumlWriter.h"
+#include "profile/Profiler.h"
+#include <algorithm>
+#include <exception>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * ============================================================
+ * sud-cycles
+ * - recursion report: every strongly connected component with
+ *   more than one function, and every function calling itself
+ * - condensed DAG (one node per component) as PlantUML
+ * - the condensation is cached in the DB (sud_scc*) and rebuilt
+ *   only when the graph generation changed
+ * ============================================================
+ */
+
+static void usage() {
+  std::cout <<
+    "sud-cycles --db <sud.db> [--format text|json] [--function <name|usr>]\n"
+    "           [--dag <out.puml|->] [--rebuild] [--stats[=json]] [--trace <file>]\n"
+    "\n"
+    "  --format    report format on stdout (default text)\n"
+    "  --function  only the component containing this function\n"
+    "  --dag       write the condensed DAG (one node per component)\n"
+    "  --rebuild   ignore the cached condensation\n";
+}
+
+static std::string jsonStr(const std::string& s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+
+// longest caller -> callee chain, counted in components
+// (edges go from higher to lower ids, so ascending id order is topological)
+static std::uint32_t longestChain(const SudCondensation& c) {
+  std::vector<SudEdge> edges = c.edges;
+  std::sort(edges.begin(), edges.end(), [](const SudEdge& a, const SudEdge& b) {
+    return a.caller < b.caller;
+  });
+  std::vector<std::uint32_t> depth(c.components.size(), 1);
+  std::uint32_t best = c.components.empty() ? 0 : 1;
+  for (const auto& e : edges) {
+    depth[e.caller] = std::max(depth[e.caller], depth[e.callee] + 1);
+    best = std::max(best, depth[e.caller]);
+  }
+  return best;
+}
+
+int main(int argc, char** argv) {
+  std::string dbPath;
+  std::string format = "text";
+  std::string function;
+  std::string dagPath;
+  bool rebuild = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a == "--db" && i + 1 < argc) { dbPath = argv[++i]; continue; }
+    if (a == "--format" && i + 1 < argc) { format = argv[++i]; continue; }
+    if (a == "--function" && i + 1 < argc) { function = argv[++i]; continue; }
+    if (a == "--dag" && i + 1 < argc) { dagPath = argv[++i]; continue; }
+    if (a == "--rebuild") { rebuild = true; continue; }
+    if (a == "--help" || a == "-h") { usage(); return 0; }
+    if (Profiler::instance().parseArg(argc, argv, i)) continue;
+    usage();
+    return 1;
+  }
+  if (dbPath.empty() || (format != "text" && format != "json")) {
+    usage();
+    return 1;
+  }
+
+  SqliteStore db(dbPath);
+  db.initSchema();
+
+  /* ---- condensation: cached, or computed once and stored ---- */
+  SudCondensation cond;
+  const bool cached = !rebuild && db.loadCondensation(cond);
+  if (!cached) {
+    SudGraph g(db.loadSudModel());
+    cond = condense(g, computeScc(g));
+    db.saveCondensation(cond);
+  }
+
+  /* ---- members per component (function ids are sorted) ---- */
+  std::vector<std::uint32_t> offsets(cond.components.size() + 1, 0);
+  for (std::uint32_t comp : cond.component) ++offsets[comp + 1];
+  for (std::size_t i = 0; i + 1 < offsets.size(); ++i) offsets[i + 1] += offsets[i];
+  std::vector<std::int64_t> members(cond.functionIds.size());
+  {
+    std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+    for (std::size_t i = 0; i < cond.functionIds.size(); ++i)
+      members[cursor[cond.component[i]]++] = cond.functionIds[i];
+  }
+
+  auto componentOf = [&](std::int64_t id) -> std::int64_t {
+    auto it = std::lower_bound(cond.functionIds.begin(), cond.functionIds.end(), id);
+    if (it == cond.functionIds.end() || *it != id) return -1;
+    return cond.component[(std::size_t)(it - cond.functionIds.begin())];
+  };
+
+  /* ---- which components to report ---- */
+  std::vector<std::uint32_t> report;
+  if (!function.empty()) {
+    const std::int64_t comp = componentOf(db.findFunctionId(function));
+    if (comp < 0) {
+      std::cerr << "function not found: " << function << "\n";
+      return 1;
+    }
+    report.push_back((std::uint32_t)comp);
+  } else {
+    for (std::uint32_t c = 0; c < cond.components.size(); ++c)
+      if (cond.components[c].recursive) report.push_back(c);
+  }
+
+  std::size_t recursiveClusters = 0;
+  std::size_t recursiveFunctions = 0;
+  for (const auto& c : cond.components) {
+    if (!c.recursive) continue;
+    ++recursiveClusters;
+    recursiveFunctions += c.size;
+  }
+
+  /* ---- report (stderr when the DAG goes to stdout) ---- */
+  std::ostream& os = dagPath == "-" ? std::cerr : std::cout;
+  const std::int64_t generation = db.generation();
+  const std::uint32_t chain = longestChain(cond);
+
+  if (format == "json") {
+    os << "{\"generation\":" << generation
+       << ",\"cached\":" << (cached ? "true" : "false")
+       << ",\"functions\":" << cond.functionIds.size()
+       << ",\"components\":" << cond.components.size()
+       << ",\"recursiveClusters\":" << recursiveClusters
+       << ",\"recursiveFunctions\":" << recursiveFunctions
+       << ",\"dagEdges\":" << cond.edges.size()
+       << ",\"longestChain\":" << chain
+       << ",\"clusters\":[";
+  } else {
+    os << "functions=" << cond.functionIds.size()
+       << ", components=" << cond.components.size()
+       << ", recursive clusters=" << recursiveClusters
+       << " (" << recursiveFunctions << " functions)"
+       << ", DAG edges=" << cond.edges.size()
+       << ", longest chain=" << chain
+       << (cached ? " [cached" : " [rebuilt") << ", generation " << generation << "]\n";
+  }
+
+  for (std::size_t r = 0; r < report.size(); ++r) {
+    const std::uint32_t comp = report[r];
+    const SudComponent& info = cond.components[comp];
+
+    if (format == "json") {
+      os << (r ? "," : "") << "\n {\"component\":" << comp
+         << ",\"size\":" << info.size
+         << ",\"recursive\":" << (info.recursive ? "true" : "false")
+         << ",\"functions\":[";
+    } else {
+      os << "\ncomponent #" << comp << " (" << info.size << " function"
+         << (info.size == 1 ? "" : "s")
+         << (info.recursive ? (info.size == 1 ? ", self-recursive)" : ", recursive)") : ")")
+         << "\n";
+    }
+
+    for (std::uint32_t k = offsets[comp]; k < offsets[comp + 1]; ++k) {
+      SudFunction f;
+      db.loadFunction(members[k], f);
+      if (format == "json") {
+        os << (k > offsets[comp] ? "," : "")
+           << "{\"name\":" << jsonStr(f.name)
+           << ",\"usr\":" << jsonStr(f.usr)
+           << ",\"file\":" << jsonStr(f.file) << "}";
+      } else {
+        os << "  " << f.name << (f.file.empty() ? "" : "  (" + f.file + ")") << "\n";
+      }
+    }
+    if (format == "json") os << "]}";
+  }
+  if (format == "json") os << "\n]}\n";
+
+  /* ---- condensed DAG ---- */
+  if (!dagPath.empty()) {
+    ScopedTimer timer("puml.emit");
+
+    // singleton: the function's name, cluster: "SCC #id (n)"; made unique
+    std::vector<std::string> labels(cond.components.size());
+    std::unordered_set<std::string> used;
+    for (std::uint32_t c = 0; c < cond.components.size(); ++c) {
+      SudFunction f;
+      db.loadFunction(members[offsets[c]], f);
+      std::string label = cond.components[c].size == 1
+        ? f.name
+        : "SCC #" + std::to_string(c) + " (" + f.name + " +" + std::to_string(cond.components[c].size - 1) + ")";
+      if (!used.insert(label).second) {
+        label += " #" + std::to_string(c);
+        used.insert(label);
+      }
+      labels[c] = std::move(label);
+    }
+
+    try {
+      PumlWriter p(dagPath);
+      p.begin();
+      for (const auto& e : cond.edges)
+        p.arrow(labels[e.caller], labels[e.callee]);
+      p.end();
+      p.close();
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << "\n";
+      return 1;
+    }
+  }
+
+  Profiler::instance().report();
+  return 0;
+}
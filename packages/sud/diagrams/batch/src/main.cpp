@@ -0,0 +1,346 @@
+#include "storage/SqliteStore.h"
+#include "storage/SudSnapshot.h"
+#include "puml/PumlWriter.h"
+#include "profile/Profiler.h"
+#include "call_graph.h"
+#include "sequence_expander.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+/*
+ * ============================================================
+ * sud-diagram-batch
+ * - many diagrams from one model load: the DB's snapshot is
+ *   mapped once and shared read-only by every worker thread
+ * - jobs from a manifest, or one job per kind for every root
+ *   listed in --roots-from
+ * - each worker keeps its own sequence expander, so callee lists
+ *   and memoised subtrees (up to --memo-bytes) carry over between
+ *   that worker's roots
+ * - per-diagram timing in manifest order, whatever order the
+ *   workers finished in
+ * ============================================================
+ */
+
+static void usage() {
+  std::cout <<
+    "sud-diagram-batch --db <sud.db> (--manifest <file> | --roots-from <file> --out-dir <dir>)\n"
+    "                  [--kinds sequence,call-graph] [--jobs N] [--snapshot <file>]\n"
+    "                  [--depth N] [--cg-depth N] [--direction callees|callers|both]\n"
+    "                  [--max-bytes N] [--memo-bytes N] [--report text|json]\n"
+    "                  [--stats[=json]] [--trace <file>]\n"
+    "\n"
+    "  --manifest    one diagram per line, '#' starts a comment:\n"
+    "                  sequence|call-graph <function> <out.puml> [depth=N] [direction=D]\n"
+    "  --roots-from  one function (name or USR) per line; writes <out-dir>/<root>.seq.puml\n"
+    "                and/or <out-dir>/<root>.cg.puml depending on --kinds (default both)\n"
+    "  --jobs N      worker threads (0 = all cores, default 0)\n"
+    "  --snapshot    model snapshot (default <db>.snap), exported first if missing or stale\n"
+    "  --depth       sequence depth (default 5)\n"
+    "  --cg-depth    call graph depth (default 3)\n"
+    "  --direction   call graph direction (default callees)\n"
+    "  --max-bytes   sequence message budget per diagram (default 16 MiB, 0 = unlimited)\n"
+    "  --memo-bytes  memoised sequence subtrees kept per worker, least recently used\n"
+    "                dropped first (default 64 MiB, 0 = unlimited)\n"
+    "  --report      per-diagram timing on stdout (default text)\n";
+}
+
+static std::string jsonStr(const std::string& s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+
+namespace {
+
+enum class Kind { Sequence, CallGraph };
+
+struct Job {
+  Kind kind = Kind::Sequence;
+  std::string root;
+  std::string out;
+  int depth = 0;
+  SqliteStore::Direction dir = SqliteStore::Direction::Callees;
+
+  /* filled by the worker */
+  double ms = 0;
+  std::size_t arrows = 0;   // call graph only
+  std::string error;
+};
+
+const char* kindName(Kind k) { return k == Kind::Sequence ? "sequence" : "call-graph"; }
+
+bool parseDirection(const std::string& d, SqliteStore::Direction& out) {
+  if (d == "callees") out = SqliteStore::Direction::Callees;
+  else if (d == "callers") out = SqliteStore::Direction::Callers;
+  else if (d == "both") out = SqliteStore::Direction::Both;
+  else return false;
+  return true;
+}
+
+struct Defaults {
+  int seqDepth = 5;
+  int cgDepth = 3;
+  SqliteStore::Direction dir = SqliteStore::Direction::Callees;
+};
+
+// non-empty lines with '#' comments removed
+std::vector<std::string> readLines(const std::string& path) {
+  std::ifstream in(path);
+  if (!in) throw std::runtime_error("Failed to open: " + path);
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(in, line)) {
+    const auto hash = line.find('#');
+    if (hash != std::string::npos) line.erase(hash);
+    line.erase(0, line.find_first_not_of(" \t\r"));
+    line.erase(line.find_last_not_of(" \t\r") + 1);
+    if (!line.empty()) lines.push_back(line);
+  }
+  return lines;
+}
+
+std::vector<Job> readManifest(const std::string& path, const Defaults& d) {
+  std::vector<Job> jobs;
+  for (const auto& line : readLines(path)) {
+    std::istringstream is(line);
+    std::string kind;
+    Job j;
+    if (!(is >> kind >> j.root >> j.out))
+      throw std::runtime_error("manifest: expected '<kind> <function> <out>': " + line);
+    if (kind == "sequence") { j.kind = Kind::Sequence; j.depth = d.seqDepth; }
+    else if (kind == "call-graph") { j.kind = Kind::CallGraph; j.depth = d.cgDepth; }
+    else throw std::runtime_error("manifest: unknown kind '" + kind + "'");
+    j.dir = d.dir;
+
+    for (std::string opt; is >> opt;) {
+      if (opt.rfind("depth=", 0) == 0) {
+        const std::string v = opt.substr(6);
+        if (v.empty() || v.size() > 9 || v.find_first_not_of("0123456789") != std::string::npos)
+          throw std::runtime_error("manifest: bad option '" + opt + "': " + line);
+        j.depth = std::stoi(v);
+        // same cap as --depth: the expander recurses once per level
+        if (j.kind == Kind::Sequence) j.depth = std::min(j.depth, 1000);
+      }
+      else if (opt.rfind("direction=", 0) == 0 && parseDirection(opt.substr(10), j.dir)) {}
+      else throw std::runtime_error("manifest: bad option '" + opt + "': " + line);
+    }
+    jobs.push_back(std::move(j));
+  }
+  return jobs;
+}
+
+// USRs / names -> file names; collisions get a numeric suffix
+std::string fileStem(const std::string& root, std::unordered_set<std::string>& used) {
+  std::string stem;
+  for (char c : root)
+    stem += (std::isalnum((unsigned char)c) || c == '_' || c == '-' || c == '.') ? c : '_';
+  if (stem.empty() || stem[0] == '.') stem.insert(0, "_");
+  std::string unique = stem;
+  for (int k = 2; !used.insert(unique).second; ++k) unique = stem + "-" + std::to_string(k);
+  return unique;
+}
+
+std::vector<Job> rootJobs(const std::string& path, const std::string& outDir,
+                          bool sequence, bool callGraph, const Defaults& d) {
+  std::vector<Job> jobs;
+  std::unordered_set<std::string> used;
+  for (const auto& root : readLines(path)) {
+    const std::string base = outDir + "/" + fileStem(root, used);
+    if (sequence) {
+      Job j;
+      j.kind = Kind::Sequence;
+      j.root = root;
+      j.out = base + ".seq.puml";
+      j.depth = d.seqDepth;
+      jobs.push_back(std::move(j));
+    }
+    if (callGraph) {
+      Job j;
+      j.kind = Kind::CallGraph;
+      j.root = root;
+      j.out = base + ".cg.puml";
+      j.depth = d.cgDepth;
+      j.dir = d.dir;
+      jobs.push_back(std::move(j));
+    }
+  }
+  return jobs;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+  std::string dbPath;
+  std::string snapshotPath;
+  std::string manifestPath;
+  std::string rootsPath;
+  std::string outDir;
+  std::string kinds = "sequence,call-graph";
+  std::string report = "text";
+  unsigned jobsWanted = 0;
+  std::size_t maxBytes = 16u << 20;
+  std::size_t memoBytes = 64u << 20;
+  Defaults defaults;
+
+  try {
+    for (int i = 1; i < argc; ++i) {
+      std::string a = argv[i];
+      if (a == "--db" && i + 1 < argc) { dbPath = argv[++i]; continue; }
+      if (a == "--snapshot" && i + 1 < argc) { snapshotPath = argv[++i]; continue; }
+      if (a == "--manifest" && i + 1 < argc) { manifestPath = argv[++i]; continue; }
+      if (a == "--roots-from" && i + 1 < argc) { rootsPath = argv[++i]; continue; }
+      if (a == "--out-dir" && i + 1 < argc) { outDir = argv[++i]; continue; }
+      if (a == "--kinds" && i + 1 < argc) { kinds = argv[++i]; continue; }
+      if (a == "--report" && i + 1 < argc) { report = argv[++i]; continue; }
+      if (a == "--jobs" && i + 1 < argc) { jobsWanted = (unsigned)std::stoul(argv[++i]); continue; }
+      if (a == "--max-bytes" && i + 1 < argc) { maxBytes = std::stoull(argv[++i]); continue; }
+      if (a == "--memo-bytes" && i + 1 < argc) { memoBytes = std::stoull(argv[++i]); continue; }
+      if (a == "--depth" && i + 1 < argc) { defaults.seqDepth = std::min(std::max(0, std::stoi(argv[++i])), 1000); continue; }
+      if (a == "--cg-depth" && i + 1 < argc) { defaults.cgDepth = std::max(0, std::stoi(argv[++i])); continue; }
+      if (a == "--direction" && i + 1 < argc && parseDirection(argv[i + 1], defaults.dir)) { ++i; continue; }
+      if (a == "--help" || a == "-h") { usage(); return 0; }
+      if (Profiler::instance().parseArg(argc, argv, i)) continue;
+      usage();
+      return 1;
+    }
+  } catch (const std::exception&) {
+    usage();
+    return 1;
+  }
+
+  const bool wantSequence = kinds.find("sequence") != std::string::npos;
+  const bool wantCallGraph = kinds.find("call-graph") != std::string::npos;
+  if (dbPath.empty() || manifestPath.empty() == rootsPath.empty() ||
+      (!rootsPath.empty() && (outDir.empty() || (!wantSequence && !wantCallGraph))) ||
+      (report != "text" && report != "json")) {
+    usage();
+    return 1;
+  }
+  if (snapshotPath.empty()) snapshotPath = dbPath + ".snap";
+
+  std::vector<Job> jobs;
+  try {
+    jobs = manifestPath.empty()
+      ? rootJobs(rootsPath, outDir, wantSequence, wantCallGraph, defaults)
+      : readManifest(manifestPath, defaults);
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+
+  /* ---- model: loaded (mapped) once for every diagram ---- */
+  const auto started = std::chrono::steady_clock::now();
+  std::unique_ptr<SudSnapshot> snapshot;
+  try {
+    SqliteStore db(dbPath);
+    db.initSchema();
+    bool rebuilt = false;
+    snapshot = SudSnapshot::openCurrent(db, snapshotPath, &rebuilt);
+    if (rebuilt) std::cerr << "snapshot exported: " << snapshotPath << "\n";
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
+  const SnapshotSequenceSource source(*snapshot);
+  const double loadMs =
+    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+  /* ---- workers: pull the next job until none are left ---- */
+  unsigned threads = jobsWanted ? jobsWanted : std::thread::hardware_concurrency();
+  threads = std::max(1u, std::min<unsigned>(threads, (unsigned)std::max<std::size_t>(jobs.size(), 1)));
+  std::atomic<std::size_t> next{ 0 };
+
+  auto worker = [&] {
+    std::unique_ptr<SequenceExpander> seq;   // one per thread, reused across roots
+    for (std::size_t k; (k = next.fetch_add(1, std::memory_order_relaxed)) < jobs.size();) {
+      Job& j = jobs[k];
+      const auto t0 = std::chrono::steady_clock::now();
+      try {
+        const SudSnapshot::NodeId root = snapshot->resolve(j.root);
+        if (root == SudSnapshot::kNone) throw std::runtime_error("function not found: " + j.root);
+
+        PumlWriter p(j.out);
+        if (j.kind == Kind::Sequence) {
+          if (!seq) seq = std::make_unique<SequenceExpander>(source, maxBytes, memoBytes);
+          seq->write(snapshot->id(root), j.depth, p);
+        } else {
+          j.arrows = writeCallGraph(*snapshot, root, j.depth, j.dir, p);
+        }
+        p.close();
+      } catch (const std::exception& e) {
+        j.error = e.what();
+      }
+      j.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+  };
+
+  std::vector<std::thread> pool;
+  pool.reserve(threads - 1);
+  for (unsigned t = 1; t < threads; ++t) pool.emplace_back(worker);
+  worker();
+  for (auto& t : pool) t.join();
+
+  const double totalMs =
+    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+
+  /* ---- report (manifest order) ---- */
+  std::size_t failed = 0;
+  double sumMs = 0;
+  for (const auto& j : jobs) {
+    failed += !j.error.empty();
+    sumMs += j.ms;
+  }
+
+  if (report == "json") {
+    std::cout << "{\"diagrams\":" << jobs.size()
+              << ",\"failed\":" << failed
+              << ",\"threads\":" << threads
+              << ",\"loadMs\":" << loadMs
+              << ",\"diagramMs\":" << sumMs
+              << ",\"wallMs\":" << totalMs
+              << ",\"jobs\":[";
+    for (std::size_t k = 0; k < jobs.size(); ++k) {
+      const Job& j = jobs[k];
+      std::cout << (k ? "," : "") << "\n {\"kind\":\"" << kindName(j.kind) << "\""
+                << ",\"root\":" << jsonStr(j.root)
+                << ",\"out\":" << jsonStr(j.out)
+                << ",\"depth\":" << j.depth
+                << ",\"ms\":" << j.ms;
+      if (j.kind == Kind::CallGraph) std::cout << ",\"arrows\":" << j.arrows;
+      if (!j.error.empty()) std::cout << ",\"error\":" << jsonStr(j.error);
+      std::cout << "}";
+    }
+    std::cout << "\n]}\n";
+  } else {
+    for (const auto& j : jobs) {
+      std::cout << kindName(j.kind) << "  " << j.root << " -> " << j.out << "  " << j.ms << " ms";
+      if (!j.error.empty()) std::cout << "  FAILED: " << j.error;
+      std::cout << "\n";
+    }
+    std::cout << "diagrams=" << jobs.size() << ", failed=" << failed
+              << ", threads=" << threads
+              << ", load=" << loadMs << " ms"
+              << ", diagram time=" << sumMs << " ms"
+              << ", wall=" << totalMs << " ms\n";
+  }
+
+  Profiler::instance().report();
+  return failed ? 1 : 0;
+}
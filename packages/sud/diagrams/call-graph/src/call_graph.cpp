@@ -0,0 +1,68 @@
+#include "call_graph.h"
+#include "profile/Profiler.h"
+
+#include <algorithm>
+
+std::vector<SudSnapshot::NodeId> snapshotSubgraph(
+    const SudSnapshot& s, SudSnapshot::NodeId root, int depth, SqliteStore::Direction dir,
+    std::vector<std::pair<std::uint32_t, std::uint32_t>>& edges) {
+  using NodeId = SudSnapshot::NodeId;
+  ScopedTimer timer("snapshot.subgraph");
+
+  // BFS distances (depth + 1 = not reached)
+  auto bfs = [&](bool down) {
+    std::unordered_map<NodeId, int> dist = { { root, 0 } };
+    std::vector<NodeId> frontier = { root };
+    for (int d = 0; d < depth && !frontier.empty(); ++d) {
+      std::vector<NodeId> next;
+      for (NodeId v : frontier)
+        for (NodeId w : down ? s.callees(v) : s.callers(v))
+          if (dist.emplace(w, d + 1).second) next.push_back(w);
+      frontier.swap(next);
+    }
+    return dist;
+  };
+
+  std::vector<std::pair<NodeId, NodeId>> pairs;   // node ids follow sud_function.id order
+  if (dir != SqliteStore::Direction::Callers) {
+    for (const auto& [v, d] : bfs(true))
+      if (d < depth)
+        for (NodeId w : s.callees(v)) pairs.emplace_back(v, w);
+  }
+  if (dir != SqliteStore::Direction::Callees) {
+    for (const auto& [v, d] : bfs(false))
+      if (d < depth)
+        for (NodeId w : s.callers(v)) pairs.emplace_back(w, v);
+  }
+  std::sort(pairs.begin(), pairs.end());
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+  std::unordered_map<NodeId, std::uint32_t> index;
+  std::vector<NodeId> nodes;
+  auto indexOf = [&](NodeId n) {
+    auto [it, added] = index.emplace(n, (std::uint32_t)nodes.size());
+    if (added) nodes.push_back(n);
+    return it->second;
+  };
+  indexOf(root);
+  for (const auto& [a, b] : pairs) {
+    const std::uint32_t ia = indexOf(a);
+    edges.emplace_back(ia, indexOf(b));
+  }
+  return nodes;
+}
+
+std::size_t writeCallGraph(const SudSnapshot& s, SudSnapshot::NodeId root, int depth,
+                           SqliteStore::Direction dir, PumlWriter& out) {
+  std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+  const auto nodes = snapshotSubgraph(s, root, depth, dir, edges);
+  const auto labels = makeLabels(nodes.size(), [&](std::size_t i) {
+    return LabelSource{ s.usr(nodes[i]), s.name(nodes[i]), s.file(nodes[i]) };
+  });
+
+  out.begin();
+  for (const auto& e : edges)
+    out.arrow(labels[e.first], labels[e.second]);
+  out.end();
+  return edges.size();
+}
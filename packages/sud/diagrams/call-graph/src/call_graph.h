@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "storage/SqliteStore.h"
+#include "storage/SudSnapshot.h"
+#include "puml/PumlWriter.h"
+
+/*
+ * ============================================================
+ * Call graph building blocks
+ * - shared by sud-call-graph and sud-diagram-batch
+ * - snapshot traversal yields the same diagram as the DB path
+ * ============================================================
+ */
+
+// function name as label; "name [file]" where the name is ambiguous in this diagram
+struct LabelSource {
+  std::string_view usr;
+  std::string_view name;
+  std::string_view file;
+};
+
+template <class Get>
+std::vector<std::string> makeLabels(std::size_t n, Get get) {
+  std::unordered_map<std::string_view, int> seen;
+  for (std::size_t i = 0; i < n; ++i) ++seen[get(i).name];
+
+  std::vector<std::string> labels;
+  labels.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    const LabelSource f = get(i);
+    const std::string name(f.name.empty() ? f.usr : f.name);
+    if (seen[f.name] > 1 && !f.file.empty())
+      labels.push_back(name + " [" + std::string(f.file) + "]");
+    else
+      labels.push_back(name);
+  }
+  return labels;
+}
+
+// same subgraph as SqliteStore::loadSubgraph (root first, edges deduplicated
+// and ordered by caller / callee id), traversed in the snapshot;
+// returns the nodes, edges index into them
+std::vector<SudSnapshot::NodeId> snapshotSubgraph(
+    const SudSnapshot& s, SudSnapshot::NodeId root, int depth, SqliteStore::Direction dir,
+    std::vector<std::pair<std::uint32_t, std::uint32_t>>& edges);
+
+// rooted call graph from the snapshot as one diagram; returns the arrow count
+std::size_t writeCallGraph(const SudSnapshot& s, SudSnapshot::NodeId root, int depth,
+                           SqliteStore::Direction dir, PumlWriter& out);
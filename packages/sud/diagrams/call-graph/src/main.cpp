@@ -1,20 +1,157 @@
 #include "storage/SqliteStore.h"
+#include "storage/SudSnapshot.h"
+#include "call_graph.h"
+#include "graph/SudGraph.h"
 #include "puml/PumlWriter.h"
+#include "profile/Profiler.h"
+#include <algorithm>
+#include <exception>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+static void usage() {
+  std::cout <<
+    "sud-call-graph --db <sud.db> --out <out.puml|-> [--root <function>] [--depth N]\n"
+    "               [--direction callees|callers|both] [--snapshot <file>]\n"
+    "               [--stats[=json]] [--trace <file>]\n"
+    "sud-call-graph <db> <out.puml>            (whole graph)\n"
+    "\n"
+    "  --out        output file, '-' = stdout (streamed, not buffered)\n"
+    "  --root       USR or function name; without it the whole graph is written\n"
+    "  --depth      hops from the root (default 3)\n"
+    "  --direction  follow callees (default), callers or both\n"
+    "  --snapshot   serve the graph from a binary snapshot (mmap), exported from\n"
+    "               the DB first if missing or older than the DB\n"
+    "  --stats      per-phase timings on stderr (text, or =json)\n"
+    "  --trace      write Chrome trace-event JSON to <file>\n";
+}
+
+// --depth: unsigned decimal only (stoi throws on text and accepts "3x")
+static bool parseDepth(const std::string& s, int& out) {
+  if (s.empty() || s.size() > 9 || s.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+  out = std::stoi(s);
+  return true;
+}
 
 int main(int argc, char** argv) {
-  if (argc < 3) {
-    std::cout << "sud-call-graph <db> <out.puml>\n";
+  std::string dbPath;
+  std::string outPath;
+  std::string root;
+  int depth = 3;
+  std::string snapshotPath;
+  SqliteStore::Direction dir = SqliteStore::Direction::Callees;
+
+  std::vector<std::string> positional;
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a == "--db" && i + 1 < argc) { dbPath = argv[++i]; continue; }
+    if (a == "--out" && i + 1 < argc) { outPath = argv[++i]; continue; }
+    if (a == "--root" && i + 1 < argc) { root = argv[++i]; continue; }
+    if (a == "--snapshot" && i + 1 < argc) { snapshotPath = argv[++i]; continue; }
+    if (a == "--depth" && i + 1 < argc) {
+      if (!parseDepth(argv[++i], depth)) { usage(); return 1; }
+      continue;
+    }
+    if (a == "--direction" && i + 1 < argc) {
+      std::string d = argv[++i];
+      if (d == "callees") dir = SqliteStore::Direction::Callees;
+      else if (d == "callers") dir = SqliteStore::Direction::Callers;
+      else if (d == "both") dir = SqliteStore::Direction::Both;
+      else { usage(); return 1; }
+      continue;
+    }
+    if (a == "--help" || a == "-h") { usage(); return 0; }
+    if (Profiler::instance().parseArg(argc, argv, i)) continue;
+    positional.push_back(a);
+  }
+
+  if (dbPath.empty() && positional.size() >= 1) dbPath = positional[0];
+  if (outPath.empty() && positional.size() >= 2) outPath = positional[1];
+  if (dbPath.empty() || outPath.empty()) {
+    usage();
     return 1;
   }
 
-  SqliteStore db(argv[1]);
-  auto model = db.loadSudModel();
+  try {
+    SqliteStore db(dbPath);
+    db.initSchema();
+
+    /* ---- collect labels + deduplicated edges ---- */
+    std::vector<std::string> labels;
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> edges;
+
+    if (!snapshotPath.empty()) {
+      // read-optimised path: strings are views into the mapping
+      bool rebuilt = false;
+      const auto snap = SudSnapshot::openCurrent(db, snapshotPath, &rebuilt);
+      if (rebuilt) std::cerr << "snapshot exported: " << snapshotPath << "\n";
+      auto source = [&](SudSnapshot::NodeId n) {
+        return LabelSource{ snap->usr(n), snap->name(n), snap->file(n) };
+      };
+
+      if (!root.empty()) {
+        const SudSnapshot::NodeId r = snap->resolve(root);
+        if (r == SudSnapshot::kNone) {
+          std::cerr << "function not found: " << root << "\n";
+          return 1;
+        }
+        const auto nodes = snapshotSubgraph(*snap, r, depth, dir, edges);
+        labels = makeLabels(nodes.size(), [&](std::size_t i) { return source(nodes[i]); });
+      } else {
+        for (SudSnapshot::NodeId n = 0; n < snap->nodeCount(); ++n) {
+          const std::size_t first = edges.size();
+          for (SudSnapshot::NodeId m : snap->callees(n)) edges.emplace_back(n, m);
+          std::sort(edges.begin() + first, edges.end());
+          edges.erase(std::unique(edges.begin() + first, edges.end()), edges.end());
+        }
+        labels = makeLabels(snap->nodeCount(), [&](std::size_t i) { return source((SudSnapshot::NodeId)i); });
+      }
+    } else {
+      SudModel model;
+      if (!root.empty()) {
+        // bounded: traversal runs in SQLite, only the subgraph is loaded
+        const std::int64_t rootId = db.findFunctionId(root);
+        if (rootId == 0) {
+          std::cerr << "function not found: " << root << "\n";
+          return 1;
+        }
+        model = db.loadSubgraph(rootId, depth, dir);
+        for (const auto& e : model.edges) edges.emplace_back(e.caller, e.callee);
+      } else {
+        SudGraph g(db.loadSudModel());
+        for (SudGraph::NodeId n = 0; n < g.nodeCount(); ++n) {
+          const std::size_t first = edges.size();
+          for (SudGraph::NodeId m : g.callees(n)) edges.emplace_back(n, m);
+          std::sort(edges.begin() + first, edges.end());
+          edges.erase(std::unique(edges.begin() + first, edges.end()), edges.end());
+        }
+        model = g.model();
+      }
+      labels = makeLabels(model.functions.size(), [&](std::size_t i) {
+        const SudFunction& f = model.functions[i];
+        return LabelSource{ f.usr, f.name, f.file };
+      });
+    }
+
+    {
+      ScopedTimer timer("puml.emit");
+      PumlWriter p(outPath);
+      p.begin();
+      for (const auto& e : edges)
+        p.arrow(labels[e.first], labels[e.second]);
+      p.end();
+      p.close();
+    }
+    Profiler::instance().count("puml.arrows", (std::int64_t)edges.size());
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
+  }
 
-  PumlWriter p;
-  p.begin();
-  for (auto& c : model.calls)
-    p.arrow(c.callerUSR, c.calleeUSR);
-  p.end();
-  p.save(argv[2]);
+  Profiler::instance().report();
 }
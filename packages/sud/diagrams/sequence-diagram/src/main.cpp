@@ -1,23 +1,98 @@
 #include "storage/SqliteStore.h"
 #include "puml/PumlWriter.h"
+#include "profile/Profiler.h"
+#include "sequence_expander.h"
+#include <algorithm>
+#include <exception>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+static void usage() {
+  std::cout <<
+    "sud-sequence-diagram <db> <function> <out.puml|-> [--depth N] [--max-bytes N]\n"
+    "                     [--snapshot <file>] [--stats[=json]] [--trace <file>]\n"
+    "\n"
+    "  <function>   function name or USR (a defined function wins over a stub)\n"
+    "  --depth      call levels expanded below the root (default 5)\n"
+    "  --max-bytes  message budget for the whole diagram, truncated with one marker\n"
+    "               (default 16 MiB, 0 = unlimited)\n"
+    "  --snapshot   read the model from a binary snapshot (mmap), exported from\n"
+    "               the DB first if missing or older than the DB\n";
+}
+
+// unsigned decimal only (stoi/stoull throw on text, accept "5x" and wrap "-1")
+static bool parseCount(const std::string& s, std::uint64_t& out) {
+  if (s.empty() || s.size() > 19 || s.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+  out = std::stoull(s);
+  return true;
+}
 
 int main(int argc, char** argv) {
-  if (argc < 4) {
-    std::cout << "sud-sequence-diagram <db> <function> <out.puml>\n";
+  std::vector<std::string> args;
+  int depth = 5;
+  std::size_t maxBytes = 16u << 20;
+  std::string snapshotPath;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a == "--depth" && i + 1 < argc) {
+      std::uint64_t v = 0;
+      if (!parseCount(argv[++i], v)) { usage(); return 1; }
+      depth = (int)std::min<std::uint64_t>(v, 1000);
+      continue;
+    }
+    if (a == "--snapshot" && i + 1 < argc) { snapshotPath = argv[++i]; continue; }
+    if (a == "--max-bytes" && i + 1 < argc) {
+      std::uint64_t v = 0;
+      if (!parseCount(argv[++i], v)) { usage(); return 1; }
+      maxBytes = (std::size_t)v;
+      continue;
+    }
+    if (a == "--help" || a == "-h") { usage(); return 0; }
+    if (Profiler::instance().parseArg(argc, argv, i)) continue;
+    args.push_back(a);
+  }
+
+  if (args.size() < 3) {
+    usage();
     return 1;
   }
 
-  std::string root = argv[2];
-  SqliteStore db(argv[1]);
-  auto model = db.loadSudModel();
+  try {
+    SqliteStore db(args[0]);
+    db.initSchema();
+
+    std::unique_ptr<SudSnapshot> snapshot;
+    std::unique_ptr<SequenceSource> source;
+    std::int64_t rootId = 0;
+    if (!snapshotPath.empty()) {
+      snapshot = SudSnapshot::openCurrent(db, snapshotPath);
+      const SudSnapshot::NodeId n = snapshot->resolve(args[1]);
+      if (n != SudSnapshot::kNone) rootId = snapshot->id(n);
+      source = std::make_unique<SnapshotSequenceSource>(*snapshot);
+    } else {
+      rootId = db.findFunctionId(args[1]);
+      source = std::make_unique<StoreSequenceSource>(db);
+    }
+    if (rootId == 0) {
+      std::cerr << "function not found: " << args[1] << "\n";
+      return 1;
+    }
 
-  PumlWriter p;
-  p.begin();
-  for (auto& c : model.calls) {
-    if (c.callerUSR == root)
-      p.arrow(c.callerUSR, c.calleeUSR);
+    {
+      SequenceExpander seq(*source, maxBytes);
+      PumlWriter p(args[2]);
+      seq.write(rootId, depth, p);
+      p.close();
+    }
+  } catch (const std::exception& e) {
+    std::cerr << e.what() << "\n";
+    return 1;
   }
-  p.end();
-  p.save(argv[3]);
+
+  Profiler::instance().report();
 }
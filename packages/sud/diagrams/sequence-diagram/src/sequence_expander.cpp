@@ -0,0 +1,283 @@
+#include "sequence_expander.h"
+#include "profile/Profiler.h"
+
+#include <climits>
+#include <unordered_set>
+
+static std::string alias(std::int64_t id) {
+  return "F" + std::to_string(id);
+}
+
+static std::uint64_t memoKey(std::int64_t id, int depth) {
+  return ((std::uint64_t)id << 16) | (std::uint16_t)depth;
+}
+
+/* ------------------------------------------------------------
+ * Sources
+ * ------------------------------------------------------------ */
+bool StoreSequenceSource::loadFunction(std::int64_t id, SudFunction& out) const {
+  return store_.loadFunction(id, out);
+}
+
+std::size_t StoreSequenceSource::countNamed(const std::string& name) const {
+  std::size_t n = 0;
+  auto c = store_.functionsNamed(name);
+  while (n < 2 && c.next()) ++n;
+  return n;
+}
+
+void StoreSequenceSource::callees(std::int64_t id, std::vector<Callee>& out) const {
+  auto c = store_.calleesOf(id);
+  while (c.next()) out.push_back(Callee{ c.function().id, c.line() });
+}
+
+bool SnapshotSequenceSource::loadFunction(std::int64_t id, SudFunction& out) const {
+  const SudSnapshot::NodeId n = snapshot_.findById(id);
+  if (n == SudSnapshot::kNone) return false;
+  out.id = id;
+  out.usr = snapshot_.usr(n);
+  out.name = snapshot_.name(n);
+  out.file = snapshot_.file(n);
+  return true;
+}
+
+std::size_t SnapshotSequenceSource::countNamed(const std::string& name) const {
+  return snapshot_.countNamed(name);
+}
+
+void SnapshotSequenceSource::callees(std::int64_t id, std::vector<Callee>& out) const {
+  const SudSnapshot::NodeId n = snapshot_.findById(id);
+  if (n == SudSnapshot::kNone) return;
+  const std::uint32_t* lines = snapshot_.calleeLines(n);
+  std::size_t i = 0;
+  for (SudSnapshot::NodeId m : snapshot_.callees(n))
+    out.push_back(Callee{ snapshot_.id(m), (int)lines[i++] });
+}
+
+SequenceExpander::SequenceExpander(const SequenceSource& source, std::size_t maxBytes,
+                                   std::size_t memoBytes)
+  : source_(source), maxBytes_(maxBytes), memoCap_(memoBytes) {}
+
+/* ------------------------------------------------------------
+ * Function rows / callee lists, read once per function
+ * ------------------------------------------------------------ */
+SequenceExpander::Node& SequenceExpander::node(std::int64_t id) {
+  auto it = nodes_.find(id);
+  if (it != nodes_.end()) return it->second;
+
+  Node n;
+  SudFunction f;
+  if (source_.loadFunction(id, f)) {
+    n.label = f.name.empty() ? f.usr : f.name;
+    n.stub = f.file.empty();
+
+    // static functions share names across files
+    if (!n.stub && source_.countNamed(f.name) > 1) n.label += " [" + f.file + "]";
+  } else {
+    n.label = alias(id);
+    n.stub = true;
+  }
+  return nodes_.emplace(id, std::move(n)).first->second;
+}
+
+const std::vector<SequenceExpander::Callee>& SequenceExpander::callees(std::int64_t id) {
+  Node& n = node(id);
+  if (!n.calleesLoaded) {
+    n.calleesLoaded = true;
+    if (!n.stub) source_.callees(id, n.callees);
+  }
+  return n.callees;
+}
+
+/* ------------------------------------------------------------
+ * Memoised subtrees, least recently used dropped first
+ * ------------------------------------------------------------ */
+// heap held by one entry (capacities: appended strings grow by doubling)
+static std::size_t footprint(const std::string& text, std::size_t ids) {
+  return text.capacity() + ids * sizeof(std::int64_t) + 128;
+}
+
+const SequenceExpander::Fragment* SequenceExpander::recall(std::uint64_t key) {
+  auto it = memo_.find(key);
+  if (it == memo_.end()) return nullptr;
+  lru_.splice(lru_.begin(), lru_, it->second.lru);
+  return &it->second.fragment;
+}
+
+const SequenceExpander::Fragment* SequenceExpander::remember(std::uint64_t key, Fragment& f) {
+  const std::size_t bytes = footprint(f.text, f.participants.capacity() + f.expanded.capacity());
+  if (memoCap_ && bytes > memoCap_) return nullptr;
+
+  auto old = memo_.find(key);
+  if (old != memo_.end()) {
+    memoBytes_ -= old->second.bytes;
+    lru_.erase(old->second.lru);
+    memo_.erase(old);
+  }
+  while (memoCap_ && !lru_.empty() && memoBytes_ + bytes > memoCap_) {
+    auto victim = memo_.find(lru_.back());
+    memoBytes_ -= victim->second.bytes;
+    memo_.erase(victim);
+    lru_.pop_back();
+    ++memoEvicted_;
+    Profiler::instance().count("seq.memo.evicted");
+  }
+
+  lru_.push_front(key);
+  memoBytes_ += bytes;
+  MemoEntry& e = memo_[key];
+  e.fragment = std::move(f);
+  e.lru = lru_.begin();
+  e.bytes = bytes;
+  return &e.fragment;
+}
+
+/* ------------------------------------------------------------
+ * Expansion
+ * ------------------------------------------------------------ */
+bool SequenceExpander::charge(std::size_t bytes) {
+  if (maxBytes_ && used_ + bytes > maxBytes_) return false;
+  used_ += bytes;
+  return true;
+}
+
+void SequenceExpander::cut(Fragment& out) {
+  // once per diagram: every caller above stops at its next callee
+  out.text += "' ... truncated: sequence output budget of " + std::to_string(maxBytes_)
+            + " bytes reached\n";
+  out.truncated = true;
+  cut_ = true;
+}
+
+bool SequenceExpander::reusable(const Fragment& f) const {
+  // a function on the current stack would be a recursion here,
+  // not the expansion the fragment recorded
+  for (std::int64_t id : f.expanded) {
+    if (onStack_.count(id)) return false;
+  }
+  return true;
+}
+
+int SequenceExpander::expand(std::int64_t id, int depth, Fragment& out) {
+  std::unordered_set<std::int64_t> seen;
+  auto addParticipant = [&](std::int64_t p) {
+    if (seen.insert(p).second) out.participants.push_back(p);
+  };
+  std::unordered_set<std::int64_t> expandedSeen = { id };
+
+  addParticipant(id);
+  out.expanded.push_back(id);
+
+  int minRef = INT_MAX;
+  const std::string from = alias(id);
+
+  for (const Callee& c : callees(id)) {
+    if (cut_) break;
+
+    const std::string to = alias(c.id);
+    std::string message = from + " -> " + to + " : " + (c.line ? "L" + std::to_string(c.line) : "call") + "\n";
+    if (!charge(message.size())) {
+      cut(out);
+      break;
+    }
+    addParticipant(c.id);
+    out.text += message;
+
+    // recursion: message only
+    auto onStack = onStack_.find(c.id);
+    if (onStack != onStack_.end()) {
+      if (onStack->second < minRef) minRef = onStack->second;
+      continue;
+    }
+    if (depth <= 1 || callees(c.id).empty()) continue;
+
+    // activate / deactivate are charged together, the closing line always fits
+    const std::string activate = "activate " + to + "\n";
+    const std::string deactivate = "deactivate " + to + "\n";
+    if (!charge(activate.size() + deactivate.size())) {
+      cut(out);
+      break;
+    }
+
+    /* ---- callee subtree: memoised or expanded now ---- */
+    const Fragment* child = nullptr;
+    Fragment fresh;
+
+    // a memoised subtree is only reused whole, and only if the budget still holds it
+    const Fragment* memo = recall(memoKey(c.id, depth - 1));
+    if (memo && reusable(*memo) && charge(memo->text.size())) {
+      child = memo;
+      ++memoHits_;
+    } else {
+      const int index = (int)onStack_.size();
+      onStack_.emplace(c.id, index);
+      const int ref = expand(c.id, depth - 1, fresh);
+      onStack_.erase(c.id);
+
+      if (ref < minRef) minRef = ref;
+      // no recursion into the stack above the callee: same result from any caller;
+      // a subtree cut by the budget depends on where it started, never kept
+      if (ref >= index && !fresh.truncated) child = remember(memoKey(c.id, depth - 1), fresh);
+      if (!child) child = &fresh;
+    }
+
+    out.text += activate;
+    out.text += child->text;
+    out.text += deactivate;
+
+    for (std::int64_t p : child->participants) addParticipant(p);
+    for (std::int64_t e : child->expanded) {
+      if (expandedSeen.insert(e).second) out.expanded.push_back(e);
+    }
+    out.truncated = out.truncated || child->truncated;
+  }
+
+  return minRef;
+}
+
+void SequenceExpander::write(std::int64_t rootId, int depth, PumlWriter& out) {
+  ScopedTimer timer("seq.expand");
+
+  Fragment fresh;
+  const Fragment* body = &fresh;
+
+  // the root has nothing above it on the stack: always memoisable
+  if (const Fragment* memo = recall(memoKey(rootId, depth))) {
+    body = memo;
+    ++memoHits_;
+  } else if (depth > 0) {
+    used_ = 0;
+    cut_ = false;
+    onStack_.clear();
+    onStack_.emplace(rootId, 0);
+    expand(rootId, depth, fresh);
+    onStack_.clear();
+    if (!fresh.truncated) {
+      if (const Fragment* kept = remember(memoKey(rootId, depth), fresh)) body = kept;
+    }
+  } else {
+    fresh.participants.push_back(rootId);
+  }
+
+  const std::string root = alias(rootId);
+
+  out.begin();
+  out.line("hide footbox");
+  out.line({ "title sud sequence (root: ", node(rootId).label, ", depth: ", std::to_string(depth), ")" });
+  out.line("");
+  for (std::int64_t p : body->participants)
+    out.line({ "participant \"", node(p).label, "\" as ", alias(p) });
+  out.line("");
+
+  out.line({ "activate ", root });
+  const std::string& text = body->text;
+  for (std::size_t pos = 0; pos < text.size();) {
+    const std::size_t nl = text.find('\n', pos);
+    out.line(std::string_view(text).substr(pos, nl - pos));
+    pos = nl + 1;
+  }
+  out.line({ "deactivate ", root });
+  out.end();
+
+  Profiler::instance().count("seq.participants", (std::int64_t)body->participants.size());
+}
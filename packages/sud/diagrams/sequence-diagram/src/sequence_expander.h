@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "storage/SqliteStore.h"
+#include "storage/SudSnapshot.h"
+#include "puml/PumlWriter.h"
+
+/*
+ * ============================================================
+ * Where the expander reads functions and callee lists from
+ * - StoreSequenceSource: SqliteStore scoped reads (single diagram)
+ * - SnapshotSequenceSource: mmap'ed snapshot, read-only, shared by
+ *   any number of threads (batch mode)
+ * ============================================================
+ */
+class SequenceSource {
+public:
+  struct Callee {
+    std::int64_t id;
+    int line;
+  };
+
+  virtual ~SequenceSource() = default;
+
+  // false if the id is unknown
+  virtual bool loadFunction(std::int64_t id, SudFunction& out) const = 0;
+  // functions carrying `name` (counting may stop at 2)
+  virtual std::size_t countNamed(const std::string& name) const = 0;
+  // call-site order, repeats kept
+  virtual void callees(std::int64_t id, std::vector<Callee>& out) const = 0;
+};
+
+class StoreSequenceSource : public SequenceSource {
+public:
+  explicit StoreSequenceSource(const SqliteStore& store) : store_(store) {}
+
+  bool loadFunction(std::int64_t id, SudFunction& out) const override;
+  std::size_t countNamed(const std::string& name) const override;
+  void callees(std::int64_t id, std::vector<Callee>& out) const override;
+
+private:
+  const SqliteStore& store_;
+};
+
+class SnapshotSequenceSource : public SequenceSource {
+public:
+  explicit SnapshotSequenceSource(const SudSnapshot& snapshot) : snapshot_(snapshot) {}
+
+  bool loadFunction(std::int64_t id, SudFunction& out) const override;
+  std::size_t countNamed(const std::string& name) const override;
+  void callees(std::int64_t id, std::vector<Callee>& out) const override;
+
+private:
+  const SudSnapshot& snapshot_;
+};
+
+/*
+ * ============================================================
+ * Sequence expansion over the SUD model
+ * - DFS from the root in call-site order (sud_call.seq), bounded
+ *   by depth; stubs (no indexed body) are never expanded
+ * - recursion: a callee already on the call stack gets its message
+ *   but is not expanded again
+ * - each function / callee list is read from the source once and
+ *   kept for every later root
+ * - expanded subtrees are memoised per (function, depth) and reused
+ *   whenever the current call stack cannot change them, so many roots
+ *   sharing callees cost little more than one; the memo holds at
+ *   most memoBytes, least recently used subtrees are dropped first
+ * - maxBytes bounds the whole diagram body (memoised subtrees
+ *   included); the truncation marker is written once
+ * - not thread safe: one expander per thread (the source may be shared)
+ * ============================================================
+ */
+class SequenceExpander {
+public:
+  explicit SequenceExpander(const SequenceSource& source, std::size_t maxBytes = 16u << 20,
+                            std::size_t memoBytes = 64u << 20);
+
+  // one complete @startuml .. @enduml diagram for rootId
+  void write(std::int64_t rootId, int depth, PumlWriter& out);
+
+  std::size_t memoHits() const { return memoHits_; }
+  std::size_t memoEvicted() const { return memoEvicted_; }
+  std::size_t functionsLoaded() const { return nodes_.size(); }
+
+private:
+  using Callee = SequenceSource::Callee;
+  struct Node {
+    std::string label;   // name, "name [file]" if the name is not unique
+    bool stub = false;
+    bool calleesLoaded = false;
+    std::vector<Callee> callees;   // call-site order
+  };
+  // messages below one function + what they depend on
+  struct Fragment {
+    std::string text;
+    std::vector<std::int64_t> participants;   // first appearance order
+    std::vector<std::int64_t> expanded;       // functions whose callees were walked
+    bool truncated = false;
+  };
+
+  struct MemoEntry {
+    Fragment fragment;
+    std::list<std::uint64_t>::iterator lru;
+    std::size_t bytes = 0;
+  };
+
+  Node& node(std::int64_t id);
+  const std::vector<Callee>& callees(std::int64_t id);
+  // returns the lowest call stack index a recursion inside refers to
+  int expand(std::int64_t id, int depth, Fragment& out);
+  bool reusable(const Fragment& f) const;
+  // nullptr if absent; a hit becomes the most recently used entry
+  const Fragment* recall(std::uint64_t key);
+  // moves f into the memo unless it alone exceeds the cap; nullptr then
+  const Fragment* remember(std::uint64_t key, Fragment& f);
+  // maxBytes_ is one budget for the whole diagram body
+  bool charge(std::size_t bytes);
+  void cut(Fragment& out);
+
+  const SequenceSource& source_;
+  std::size_t maxBytes_;
+  std::size_t memoCap_;   // 0 = unbounded
+
+  std::unordered_map<std::int64_t, Node> nodes_;
+  std::unordered_map<std::uint64_t, MemoEntry> memo_;   // (id << 16) | depth
+  std::list<std::uint64_t> lru_;                       // most recent first
+  std::size_t memoBytes_ = 0;
+  std::unordered_map<std::int64_t, int> onStack_;      // id -> call stack index
+  std::size_t memoHits_ = 0;
+  std::size_t memoEvicted_ = 0;
+  std::size_t used_ = 0;   // bytes of the current diagram's body
+  bool cut_ = false;       // budget ran out, marker written
+};
@@ -0,0 +1,149 @@
+#include "storage/SqliteStore.h"
+#include "graph/Reachability.h"
+#include "profile/Profiler.h"
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/*
+ * ============================================================
+ * sud-impact
+ * - every function that calls --fn, directly or transitively
+ * - answered from the reachability index (sud_reach*); the
+ *   index is rebuilt first if the graph generation moved on
+ * ============================================================
+ */
+
+static void usage() {
+  std::cout <<
+    "sud-impact --db <sud.db> --fn <name|usr> [--from <name|usr>] [--entry]\n"
+    "           [--format text|json] [--rebuild] [--max-intervals N]\n"
+    "           [--stats[=json]] [--trace <file>]\n"
+    "\n"
+    "  --fn       impacted function\n"
+    "  --from     only answer whether this function reaches --fn (exit 0 yes, 2 no)\n"
+    "  --entry    only callers nothing calls (tasks, runnables, ISRs, ...)\n"
+    "  --format   output format on stdout (default text)\n"
+    "  --rebuild  rebuild the condensation and reachability index\n"
+    "  --max-intervals N\n"
+    "             label size cap per component when the index is (re)built (default 64);\n"
+    "             larger: fewer walks on dense graphs, bigger index\n";
+}
+
+static std::string jsonStr(const std::string& s) {
+  std::string out = "\"";
+  for (char c : s) {
+    if (c == '"' || c == '\\') out += '\\';
+    out += c;
+  }
+  return out + "\"";
+}
+
+// --max-intervals: unsigned decimal only (stoul throws on text and wraps "-1")
+static bool parseMaxIntervals(const std::string& s, std::size_t& out) {
+  if (s.empty() || s.size() > 9 || s.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+  out = (std::size_t)std::stoul(s);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  std::string dbPath;
+  std::string function;
+  std::string from;
+  std::string format = "text";
+  bool entryOnly = false;
+  bool rebuild = false;
+  std::size_t maxIntervals = kReachMaxIntervals;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string a = argv[i];
+    if (a == "--db" && i + 1 < argc) { dbPath = argv[++i]; continue; }
+    if (a == "--fn" && i + 1 < argc) { function = argv[++i]; continue; }
+    if (a == "--from" && i + 1 < argc) { from = argv[++i]; continue; }
+    if (a == "--format" && i + 1 < argc) { format = argv[++i]; continue; }
+    if (a == "--entry") { entryOnly = true; continue; }
+    if (a == "--rebuild") { rebuild = true; continue; }
+    if (a == "--max-intervals" && i + 1 < argc) {
+      if (!parseMaxIntervals(argv[++i], maxIntervals)) { usage(); return 1; }
+      continue;
+    }
+    if (a == "--help" || a == "-h") { usage(); return 0; }
+    if (Profiler::instance().parseArg(argc, argv, i)) continue;
+    usage();
+    return 1;
+  }
+  if (dbPath.empty() || function.empty() || (format != "text" && format != "json")) {
+    usage();
+    return 1;
+  }
+
+  SqliteStore db(dbPath);
+  db.initSchema();
+  const bool rebuilt = refreshReachIndex(db, rebuild, maxIntervals);
+
+  const std::int64_t targetId = db.findFunctionId(function);
+  if (targetId == 0) {
+    std::cerr << "function not found: " << function << "\n";
+    return 1;
+  }
+
+  /* ---- single query: does --from reach --fn ---- */
+  if (!from.empty()) {
+    const std::int64_t fromId = db.findFunctionId(from);
+    if (fromId == 0) {
+      std::cerr << "function not found: " << from << "\n";
+      return 1;
+    }
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const bool yes = db.callsTransitively(fromId, targetId);
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - t0).count();
+
+    if (format == "json") {
+      std::cout << "{\"from\":" << jsonStr(from) << ",\"fn\":" << jsonStr(function)
+                << ",\"reaches\":" << (yes ? "true" : "false") << ",\"us\":" << us << "}\n";
+    } else {
+      std::cout << from << (yes ? " reaches " : " does not reach ") << function
+                << " (" << us << " us)\n";
+    }
+    Profiler::instance().report();
+    return yes ? 0 : 2;
+  }
+
+  /* ---- every transitive caller ---- */
+  const auto t0 = std::chrono::steady_clock::now();
+  std::size_t count = 0;
+
+  if (format == "json") std::cout << "{\"fn\":" << jsonStr(function) << ",\"callers\":[";
+  {
+    ScopedTimer timer("impact.query");
+    for (const SudFunction& f : db.transitiveCallers(targetId, entryOnly)) {
+      if (format == "json") {
+        std::cout << (count ? "," : "") << "\n {\"name\":" << jsonStr(f.name)
+                  << ",\"usr\":" << jsonStr(f.usr)
+                  << ",\"file\":" << jsonStr(f.file) << "}";
+      } else {
+        std::cout << f.name << (f.file.empty() ? "" : "  (" + f.file + ")") << "\n";
+      }
+      ++count;
+    }
+  }
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+    std::chrono::steady_clock::now() - t0).count();
+
+  if (format == "json") {
+    std::cout << "\n],\"count\":" << count << ",\"us\":" << us
+              << ",\"indexRebuilt\":" << (rebuilt ? "true" : "false") << "}\n";
+  } else {
+    std::cerr << count << (entryOnly ? " entry point" : " caller") << (count == 1 ? "" : "s")
+              << " of " << function << " (" << us << " us"
+              << (rebuilt ? ", index rebuilt" : "") << ")\n";
+  }
+
+  Profiler::instance().count("impact.callers", (std::int64_t)count);
+  Profiler::instance().report();
+  return 0;
+}
@@ -0,0 +1,92 @@
+#include "compile_db.h"
+
+#include <clang-c/CXCompilationDatabase.h>
+#include <filesystem>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+static std::string toStd(CXString s) {
+  std::string out = clang_getCString(s) ? clang_getCString(s) : "";
+  clang_disposeString(s);
+  return out;
+}
+
+static CompileEntry toEntry(CXCompileCommand cmd) {
+  CompileEntry e;
+  const std::string dir = toStd(clang_CompileCommand_getDirectory(cmd));
+
+  fs::path file = toStd(clang_CompileCommand_getFilename(cmd));
+  if (file.is_relative()) file = fs::path(dir) / file;
+  e.file = file.lexically_normal().string();
+
+  const std::string rawFile = toStd(clang_CompileCommand_getFilename(cmd));
+  const unsigned n = clang_CompileCommand_getNumArgs(cmd);
+
+  // arg 0 is the compiler driver
+  for (unsigned i = 1; i < n; ++i) {
+    std::string a = toStd(clang_CompileCommand_getArg(cmd, i));
+
+    if (a == "-c") continue;
+    if (a == "-o") { ++i; continue; }
+    if (a.rfind("-o", 0) == 0 && a.size() > 2) continue;
+    if (a == rawFile || a == e.file) continue;
+
+    e.args.push_back(std::move(a));
+  }
+
+  if (!dir.empty()) e.args.push_back("-working-directory=" + dir);
+  return e;
+}
+
+CompileDb::CompileDb(const std::string& path)
+  : db_(nullptr)
+{
+  fs::path dir = path;
+  if (fs::is_regular_file(dir)) dir = dir.parent_path();
+  if (dir.empty()) dir = ".";
+
+  CXCompilationDatabase_Error err = CXCompilationDatabase_NoError;
+  db_ = clang_CompilationDatabase_fromDirectory(dir.string().c_str(), &err);
+  if (err != CXCompilationDatabase_NoError || !db_) {
+    throw std::runtime_error("Failed to load compilation database: " + path);
+  }
+}
+
+CompileDb::~CompileDb() {
+  if (db_) {
+    clang_CompilationDatabase_dispose(db_);
+    db_ = nullptr;
+  }
+}
+
+bool CompileDb::lookup(const std::string& file, std::vector<std::string>& args) const {
+  std::error_code ec;
+  const std::string abs = fs::absolute(file, ec).lexically_normal().string();
+
+  CXCompileCommands cmds = clang_CompilationDatabase_getCompileCommands(db_, abs.c_str());
+  if (!cmds) return false;
+
+  bool found = false;
+  if (clang_CompileCommands_getSize(cmds) > 0) {
+    args = toEntry(clang_CompileCommands_getCommand(cmds, 0)).args;
+    found = true;
+  }
+  clang_CompileCommands_dispose(cmds);
+  return found;
+}
+
+std::vector<CompileEntry> CompileDb::all() const {
+  std::vector<CompileEntry> out;
+
+  CXCompileCommands cmds = clang_CompilationDatabase_getAllCompileCommands(db_);
+  if (!cmds) return out;
+
+  const unsigned n = clang_CompileCommands_getSize(cmds);
+  out.reserve(n);
+  for (unsigned i = 0; i < n; ++i) {
+    out.push_back(toEntry(clang_CompileCommands_getCommand(cmds, i)));
+  }
+  clang_CompileCommands_dispose(cmds);
+  return out;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+/*
+ * compile_commands.json access through libclang.
+ * Args are reduced to what clang_parseTranslationUnit needs:
+ * compiler name, -c, -o <out> and the input file are dropped and
+ * -working-directory=<entry dir> is added so relative -I paths resolve.
+ */
+struct CompileEntry {
+  std::string file;                 // absolute source path
+  std::vector<std::string> args;
+};
+
+class CompileDb {
+public:
+  // path: directory containing compile_commands.json, or the file itself
+  explicit CompileDb(const std::string& path);
+  ~CompileDb();
+
+  CompileDb(const CompileDb&) = delete;
+  CompileDb& operator=(const CompileDb&) = delete;
+
+  // flags for one file; false if the database has no entry for it
+  bool lookup(const std::string& file, std::vector<std::string>& args) const;
+
+  // every entry, in database order
+  std::vector<CompileEntry> all() const;
+
+private:
+  void* db_;   // CXCompilationDatabase
+};
@@ -1,7 +1,13 @@
 #include "extractor_clang.h"
+#include "pch_cache.h"
+#include "profile/Profiler.h"
 #include <clang-c/Index.h>
+#include <chrono>
+#include <stdexcept>
 #include <unordered_map>
 #include <iostream>
+#include <string>
+#include <vector>
 
 static std::string toStd(CXString s) {
   std::string out = clang_getCString(s) ? clang_getCString(s) : "";
@@ -26,6 +32,7 @@ struct VisitorCtx {
   // current function USR while visiting its body
   std::string currentFuncUSR;
   std::string currentFuncName;
+  CXType currentResultType{};
 };
 
 static bool isFromMainFile(CXCursor c) {
@@ -39,9 +46,260 @@ static bool isFunctionDecl(CXCursor c) {
          k == CXCursor_Constructor || k == CXCursor_Destructor;
 }
 
+/* ------------------------------------------------------------
+ * Function pointer facts (points-to input, flow-insensitive)
+ * - stores into a cell that can hold a function address:
+ *   initializers (init lists element / field-wise), assignments,
+ *   arguments of direct calls, return values
+ * - a value is a function address or another cell; casts, parens,
+ *   & / * and subscripts are looked through (an array and a
+ *   pointer into it share the cell)
+ * ------------------------------------------------------------ */
+
+static CXChildVisitResult collectChild(CXCursor c, CXCursor, CXClientData out) {
+  reinterpret_cast<std::vector<CXCursor>*>(out)->push_back(c);
+  return CXChildVisit_Continue;
+}
+
+static std::vector<CXCursor> children(CXCursor c) {
+  std::vector<CXCursor> out;
+  clang_visitChildren(c, collectChild, &out);
+  return out;
+}
+
+static CXChildVisitResult takeFirstChild(CXCursor c, CXCursor, CXClientData out) {
+  *reinterpret_cast<CXCursor*>(out) = c;
+  return CXChildVisit_Break;
+}
+
+static CXCursor firstChild(CXCursor c) {
+  CXCursor out = clang_getNullCursor();
+  clang_visitChildren(c, takeFirstChild, &out);
+  return out;
+}
+
+static enum CXVisitorResult collectField(CXCursor c, CXClientData out) {
+  reinterpret_cast<std::vector<CXCursor>*>(out)->push_back(c);
+  return CXVisit_Continue;
+}
+
+// pointer / array levels down to a function type
+static bool holdsFunctionAddress(CXType t) {
+  t = clang_getCanonicalType(t);
+  for (int level = 0; level < 4; ++level) {
+    switch (t.kind) {
+      case CXType_FunctionProto:
+      case CXType_FunctionNoProto:
+        return level > 0;
+      case CXType_Pointer:
+        t = clang_getCanonicalType(clang_getPointeeType(t));
+        break;
+      case CXType_ConstantArray:
+      case CXType_IncompleteArray:
+      case CXType_VariableArray:
+      case CXType_DependentSizedArray:
+        t = clang_getCanonicalType(clang_getArrayElementType(t));
+        break;
+      default:
+        return false;
+    }
+  }
+  return false;
+}
+
+static bool isArrayType(CXType t) {
+  return t.kind == CXType_ConstantArray || t.kind == CXType_IncompleteArray ||
+         t.kind == CXType_VariableArray || t.kind == CXType_DependentSizedArray;
+}
+
+static std::string paramCell(const std::string& functionUSR, int index) {
+  return functionUSR + "#" + std::to_string(index);
+}
+
+// variable / field: its USR; parameter: "<function USR>#<index>" so that
+// call sites in other TUs (seeing only a prototype) name the same cell
+static std::string cellOfDecl(CXCursor d) {
+  switch (clang_getCursorKind(d)) {
+    case CXCursor_VarDecl:
+    case CXCursor_FieldDecl:
+      return toStd(clang_getCursorUSR(d));
+    case CXCursor_ParmDecl: {
+      const std::string usr = toStd(clang_getCursorUSR(d));
+      const CXCursor fn = clang_getCursorSemanticParent(d);
+      if (isFunctionDecl(fn)) {
+        const int n = clang_Cursor_getNumArguments(fn);
+        for (int i = 0; i < n; ++i)
+          if (toStd(clang_getCursorUSR(clang_Cursor_getArgument(fn, (unsigned)i))) == usr)
+            return paramCell(toStd(clang_getCursorUSR(fn)), i);
+      }
+      return usr;
+    }
+    default:
+      return "";
+  }
+}
+
+// implicit casts and parens only (the expression keeps its meaning)
+static CXCursor stripImplicit(CXCursor e) {
+  for (;;) {
+    const auto k = clang_getCursorKind(e);
+    if (k != CXCursor_UnexposedExpr && k != CXCursor_ParenExpr) return e;
+    const CXCursor inner = firstChild(e);
+    if (clang_Cursor_isNull(inner)) return e;
+    e = inner;
+  }
+}
+
+struct PtrValue {
+  bool address;        // function address (key = USR) or a cell
+  std::string key;
+  std::string name;
+};
+
+static void ptrValues(CXCursor e, std::vector<PtrValue>& out) {
+  // look through casts, parens, & / * and subscripts (base operand)
+  for (;;) {
+    const auto k = clang_getCursorKind(e);
+    if (k != CXCursor_UnexposedExpr && k != CXCursor_ParenExpr && k != CXCursor_CStyleCastExpr &&
+        k != CXCursor_UnaryOperator && k != CXCursor_ArraySubscriptExpr) {
+      break;
+    }
+    const std::vector<CXCursor> kids = children(e);
+    if (kids.empty()) return;
+    e = k == CXCursor_ArraySubscriptExpr ? kids.front() : kids.back();
+  }
+
+  switch (clang_getCursorKind(e)) {
+    case CXCursor_DeclRefExpr:
+    case CXCursor_MemberRefExpr: {
+      const CXCursor d = clang_getCursorReferenced(e);
+      if (clang_Cursor_isNull(d)) return;
+      if (isFunctionDecl(d)) {
+        out.push_back(PtrValue{ true, toStd(clang_getCursorUSR(d)), toStd(clang_getCursorSpelling(d)) });
+        return;
+      }
+      std::string cell = cellOfDecl(d);
+      if (!cell.empty()) out.push_back(PtrValue{ false, std::move(cell), "" });
+      return;
+    }
+    case CXCursor_ConditionalOperator: {
+      // c ? a : b (both arms), GNU c ?: b (c is the first arm)
+      const std::vector<CXCursor> kids = children(e);
+      for (std::size_t i = kids.size() >= 3 ? 1 : 0; i < kids.size(); ++i) ptrValues(kids[i], out);
+      return;
+    }
+    case CXCursor_BinaryOperator:
+      // (fp = f) has fp's value; only assignments yield function pointers
+      if (holdsFunctionAddress(clang_getCursorType(e))) ptrValues(firstChild(e), out);
+      return;
+    case CXCursor_CallExpr: {
+      const CXCursor d = clang_getCursorReferenced(e);
+      if (!clang_Cursor_isNull(d) && isFunctionDecl(d))
+        out.push_back(PtrValue{ false, toStd(clang_getCursorUSR(d)) + "#ret", "" });
+      return;
+    }
+    default:
+      return;
+  }
+}
+
+static void storeValue(VisitorCtx* ctx, const std::string& cell, CXType type, CXCursor value);
+
+// { f, g } / { .cb = f }: array elements share the array's cell,
+// struct members go to their field's cell (positional or designated)
+static void storeInitList(VisitorCtx* ctx, const std::string& cell, CXType type, CXCursor list) {
+  const CXType t = clang_getCanonicalType(type);
+  const std::vector<CXCursor> items = children(list);
+
+  if (isArrayType(t)) {
+    const CXType element = clang_getArrayElementType(t);
+    for (const CXCursor& item : items) {
+      // [i] = v: designator + value
+      const std::vector<CXCursor> parts = clang_getCursorKind(item) == CXCursor_UnexposedExpr
+        ? children(item) : std::vector<CXCursor>{};
+      storeValue(ctx, cell, element, parts.size() >= 2 ? parts.back() : item);
+    }
+    return;
+  }
+  if (t.kind != CXType_Record) return;
+
+  std::vector<CXCursor> fields;
+  clang_Type_visitFields(t, collectField, &fields);
+  std::size_t next = 0;
+
+  for (const CXCursor& item : items) {
+    CXCursor field = clang_getNullCursor();
+    CXCursor value = item;
+
+    const std::vector<CXCursor> parts = clang_getCursorKind(item) == CXCursor_UnexposedExpr
+      ? children(item) : std::vector<CXCursor>{};
+    if (parts.size() >= 2 && clang_getCursorKind(parts[0]) == CXCursor_MemberRef) {
+      // .a.b = v: the value lands in the innermost field, positional
+      // initializers continue after the outermost one
+      const std::string outer = toStd(clang_getCursorUSR(clang_getCursorReferenced(parts[0])));
+      for (std::size_t k = 0; k < fields.size(); ++k)
+        if (toStd(clang_getCursorUSR(fields[k])) == outer) next = k + 1;
+      for (std::size_t k = 0; k + 1 < parts.size(); ++k)
+        if (clang_getCursorKind(parts[k]) == CXCursor_MemberRef) field = clang_getCursorReferenced(parts[k]);
+      value = parts.back();
+    } else if (next < fields.size()) {
+      field = fields[next++];
+    }
+
+    if (!clang_Cursor_isNull(field))
+      storeValue(ctx, toStd(clang_getCursorUSR(field)), clang_getCursorType(field), value);
+  }
+}
+
+static void storeValue(VisitorCtx* ctx, const std::string& cell, CXType type, CXCursor value) {
+  if (clang_getCursorKind(value) == CXCursor_InitListExpr) {
+    storeInitList(ctx, cell, type, value);
+    return;
+  }
+  if (cell.empty() || !holdsFunctionAddress(type)) return;
+
+  std::vector<PtrValue> values;
+  ptrValues(value, values);
+  for (auto& v : values) {
+    if (!v.address && v.key == cell) continue;
+    ctx->ir->pointerFacts.push_back(IRPointerFact{ cell, std::move(v.key), std::move(v.name), v.address });
+  }
+}
+
+static void addCall(VisitorCtx* ctx, CXCursor site, std::string calleeUSR, std::string calleeName,
+                    const char* callType) {
+  IRCall call;
+  call.callerUSR = ctx->currentFuncUSR;
+  call.callerName = ctx->currentFuncName;
+  call.calleeUSR = std::move(calleeUSR);
+  call.calleeName = std::move(calleeName);
+  if (call.calleeName.empty()) call.calleeName = "(unknown)";
+  call.callType = callType;
+
+  // call location
+  CXSourceLocation loc = clang_getCursorLocation(site);
+  call.filePath = getFilePath(loc);
+  unsigned line, col, off;
+  CXFile file;
+  clang_getSpellingLocation(loc, &file, &line, &col, &off);
+  call.line = (int)line;
+
+  // record name map
+  if (call.callType == "direct" && !call.calleeUSR.empty())
+    ctx->usrToName[call.calleeUSR] = call.calleeName;
+
+  ctx->ir->calls.push_back(std::move(call));
+}
+
 static CXChildVisitResult visitor(CXCursor c, CXCursor parent, CXClientData client_data) {
   auto* ctx = reinterpret_cast<VisitorCtx*>(client_data);
 
+  // Outside a function body only main-file declarations matter;
+  // don't walk the (large) included header set.
+  if (ctx->currentFuncUSR.empty() && !isFromMainFile(c)) {
+    return CXChildVisit_Continue;
+  }
+
   // Function declaration
   if (isFunctionDecl(c) && isFromMainFile(c)) {
     IRFunction fn;
@@ -76,97 +334,182 @@ static CXChildVisitResult visitor(CXCursor c, CXCursor parent, CXClientData clie
     // traverse its children with current function context
     auto prevUSR = ctx->currentFuncUSR;
     auto prevName = ctx->currentFuncName;
+    auto prevResult = ctx->currentResultType;
     ctx->currentFuncUSR = fn.usr;
     ctx->currentFuncName = fn.name;
+    ctx->currentResultType = clang_getCursorResultType(c);
 
     clang_visitChildren(c, visitor, client_data);
 
     ctx->currentFuncUSR = prevUSR;
     ctx->currentFuncName = prevName;
+    ctx->currentResultType = prevResult;
 
     return CXChildVisit_Continue;
   }
 
+  const CXCursorKind kind = clang_getCursorKind(c);
+
+  // Variable with an initializer (global or local)
+  if (kind == CXCursor_VarDecl) {
+    const CXType type = clang_getCursorType(c);
+    const CXType canonical = clang_getCanonicalType(type);
+    if (holdsFunctionAddress(type) || canonical.kind == CXType_Record || isArrayType(canonical)) {
+      const std::vector<CXCursor> kids = children(c);
+      if (!kids.empty() && clang_isExpression(clang_getCursorKind(kids.back())))
+        storeValue(ctx, toStd(clang_getCursorUSR(c)), type, kids.back());
+    }
+    return CXChildVisit_Recurse;
+  }
+
+  // Assignment to a function pointer (variable, field, array element)
+  if (kind == CXCursor_BinaryOperator && holdsFunctionAddress(clang_getCursorType(c))) {
+    const std::vector<CXCursor> kids = children(c);
+    if (kids.size() == 2) {
+      std::vector<PtrValue> targets;
+      ptrValues(kids[0], targets);
+      for (const auto& t : targets)
+        if (!t.address) storeValue(ctx, t.key, clang_getCursorType(c), kids[1]);
+    }
+    return CXChildVisit_Recurse;
+  }
+
+  // Function pointer returned
+  if (kind == CXCursor_ReturnStmt && !ctx->currentFuncUSR.empty() &&
+      holdsFunctionAddress(ctx->currentResultType)) {
+    const CXCursor value = firstChild(c);
+    if (!clang_Cursor_isNull(value))
+      storeValue(ctx, ctx->currentFuncUSR + "#ret", ctx->currentResultType, value);
+    return CXChildVisit_Recurse;
+  }
+
   // Call expression (inside a function body)
-  if (clang_getCursorKind(c) == CXCursor_CallExpr && !ctx->currentFuncUSR.empty()) {
-    // Try resolve direct callee
+  if (kind == CXCursor_CallExpr && !ctx->currentFuncUSR.empty()) {
+    // direct: the callee expression names the function itself
+    // (get()() references get as well, but calls its result)
     CXCursor callee = clang_getCursorReferenced(c);
-    if (!clang_Cursor_isNull(callee) && isFunctionDecl(callee)) {
-      IRCall call;
-      call.callerUSR = ctx->currentFuncUSR;
-      call.callerName = ctx->currentFuncName;
-
-      call.calleeUSR = toStd(clang_getCursorUSR(callee));
-      call.calleeName = toStd(clang_getCursorSpelling(callee));
-      if (call.calleeName.empty()) call.calleeName = "(unknown)";
-
-      // call location
-      CXSourceLocation loc = clang_getCursorLocation(c);
-      call.filePath = getFilePath(loc);
-      unsigned line, col, off;
-      CXFile file;
-      clang_getSpellingLocation(loc, &file, &line, &col, &off);
-      call.line = (int)line;
-
-      ctx->ir->calls.push_back(call);
-
-      // record name map
-      if (!call.calleeUSR.empty() && !call.calleeName.empty())
-        ctx->usrToName[call.calleeUSR] = call.calleeName;
+    bool direct = !clang_Cursor_isNull(callee) && isFunctionDecl(callee) &&
+                  clang_getCursorKind(stripImplicit(firstChild(c))) != CXCursor_CallExpr;
+
+    if (direct) {
+      std::string calleeUSR = toStd(clang_getCursorUSR(callee));
+
+      // function addresses passed as arguments reach the parameters
+      const int n = clang_Cursor_getNumArguments(c);
+      for (int i = 0; i < n; ++i) {
+        const CXCursor arg = clang_Cursor_getArgument(c, (unsigned)i);
+        storeValue(ctx, paramCell(calleeUSR, i), clang_getCursorType(arg), arg);
+      }
+
+      addCall(ctx, c, std::move(calleeUSR), toStd(clang_getCursorSpelling(callee)), "direct");
+    } else {
+      // through a pointer: one call per cell (or function) the callee expression names
+      std::vector<PtrValue> values;
+      ptrValues(firstChild(c), values);
+      for (auto& v : values)
+        addCall(ctx, c, std::move(v.key), v.address ? std::move(v.name) : toStd(clang_getCursorSpelling(c)),
+                v.address ? "direct" : "indirect");
     }
   }
 
   return CXChildVisit_Recurse;
 }
 
-IRTranslationUnit ClangExtractor::parse(const ClangTUInput& in) {
-  IRTranslationUnit out;
+// with a PCH the TU cursor would otherwise walk (and deserialize) every
+// prefix-header decl; the visitor only wants main-file decls anyway
+ClangExtractor::ClangExtractor(PchCache* pch)
+  : index_(clang_createIndex(/*excludeDeclsFromPCH*/pch ? 1 : 0, /*displayDiagnostics*/0)),
+    pch_(pch)
+{
+}
 
-  CXIndex index = clang_createIndex(/*excludeDeclsFromPCH*/0, /*displayDiagnostics*/0);
+ClangExtractor::~ClangExtractor() {
+  if (index_) {
+    clang_disposeIndex(reinterpret_cast<CXIndex>(index_));
+    index_ = nullptr;
+  }
+}
 
+// a PCH clang refuses (stale input file, version mismatch) is a fatal error
+static bool hasFatalDiagnostic(CXTranslationUnit tu) {
+  unsigned n = clang_getNumDiagnostics(tu);
+  for (unsigned i = 0; i < n; ++i) {
+    CXDiagnostic d = clang_getDiagnostic(tu, i);
+    bool fatal = clang_getDiagnosticSeverity(d) == CXDiagnostic_Fatal;
+    clang_disposeDiagnostic(d);
+    if (fatal) return true;
+  }
+  return false;
+}
+
+static void collectInclusion(CXFile file, CXSourceLocation*, unsigned depth, CXClientData data) {
+  if (depth == 0) return;  // the main file itself
+  static_cast<std::vector<std::string>*>(data)->push_back(toStd(clang_getFileName(file)));
+}
+
+static CXTranslationUnit parseWith(void* index, const ClangTUInput& in,
+                                   const std::string& pchPath) {
   std::vector<const char*> cargs;
-  cargs.reserve(in.args.size());
+  cargs.reserve(in.args.size() + 2);
   for (auto& a : in.args) cargs.push_back(a.c_str());
+  if (!pchPath.empty()) {
+    cargs.push_back("-include-pch");
+    cargs.push_back(pchPath.c_str());
+  }
 
-  CXTranslationUnit tu = clang_parseTranslationUnit(
-    index,
+  // Single parse with bodies: CallExpr cursors only exist inside bodies,
+  // so a SkipFunctionBodies pass cannot serve the extraction.
+  return clang_parseTranslationUnit(
+    reinterpret_cast<CXIndex>(index),
     in.sourcePath.c_str(),
     cargs.data(),
     (int)cargs.size(),
     nullptr,
     0,
-    CXTranslationUnit_SkipFunctionBodies  // ⚠️ Phase1에서는 CallExpr를 얻기 위해 바디 필요!
+    CXTranslationUnit_None
   );
+}
 
-  // NOTE: SkipFunctionBodies면 CallExpr 못 얻는다. 그래서 Phase1은 bodies 포함.
-  if (!tu) {
-    clang_disposeIndex(index);
-    throw std::runtime_error("Failed to parse TU: " + in.sourcePath);
+IRTranslationUnit ClangExtractor::parse(const ClangTUInput& in) {
+  IRTranslationUnit out;
+
+  auto t0 = std::chrono::steady_clock::now();
+
+  const std::string pchPath = pch_ ? pch_->acquire(in.args, &out.includes) : "";
+  CXTranslationUnit tu = parseWith(index_, in, pchPath);
+
+  if (!pchPath.empty() && (!tu || hasFatalDiagnostic(tu))) {
+    if (tu) clang_disposeTranslationUnit(tu);
+    pch_->invalidate(in.args);
+    out.includes.clear();
+    tu = parseWith(index_, in, "");
   }
+  const auto tParsed = std::chrono::steady_clock::now();
+  out.timings.parseMs = std::chrono::duration<double, std::milli>(tParsed - t0).count();
 
-  // Re-parse with bodies enabled (safe)
-  clang_disposeTranslationUnit(tu);
-  tu = clang_parseTranslationUnit(
-    index,
-    in.sourcePath.c_str(),
-    cargs.data(),
-    (int)cargs.size(),
-    nullptr,
-    0,
-    CXTranslationUnit_None
-  );
   if (!tu) {
-    clang_disposeIndex(index);
-    throw std::runtime_error("Failed to parse TU(with bodies): " + in.sourcePath);
+    throw std::runtime_error("Failed to parse TU: " + in.sourcePath);
   }
 
+  auto t1 = std::chrono::steady_clock::now();
   CXCursor root = clang_getTranslationUnitCursor(tu);
   VisitorCtx ctx;
   ctx.ir = &out;
   clang_visitChildren(root, visitor, &ctx);
+  // dependencies for incremental indexing (a PCH's own headers came from acquire)
+  clang_getInclusions(tu, collectInclusion, &out.includes);
+  const auto tVisited = std::chrono::steady_clock::now();
+  out.timings.visitMs = std::chrono::duration<double, std::milli>(tVisited - t1).count();
+
+  Profiler& prof = Profiler::instance();
+  if (prof.enabled()) {
+    prof.addPhase("clang.parse", t0, tParsed);
+    prof.addPhase("clang.visit", t1, tVisited);
+    prof.count("ir.functions", (std::int64_t)out.functions.size());
+    prof.count("ir.calls", (std::int64_t)out.calls.size());
+  }
 
   clang_disposeTranslationUnit(tu);
-  clang_disposeIndex(index);
 
   return out;
 }
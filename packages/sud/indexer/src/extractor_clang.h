@@ -5,12 +5,28 @@
 #include <string>
 #include <vector>
 
+class PchCache;
+
 struct ClangTUInput {
   std::string sourcePath;
   std::vector<std::string> args;
 };
 
+/*
+ * One CXIndex per extractor, reused for every parse() call.
+ * Not thread-safe: use one extractor per thread (the PchCache is shared).
+ */
 class ClangExtractor {
 public:
+  explicit ClangExtractor(PchCache* pch = nullptr);
+  ~ClangExtractor();
+
+  ClangExtractor(const ClangExtractor&) = delete;
+  ClangExtractor& operator=(const ClangExtractor&) = delete;
+
   IRTranslationUnit parse(const ClangTUInput& in);
+
+private:
+  void* index_;   // CXIndex
+  PchCache* pch_; // optional, not owned
 };
@@ -0,0 +1,56 @@
+#include "file_hash.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+constexpr std::uint64_t kFnvOffset = 1469598103934665603ull;
+constexpr std::uint64_t kFnvPrime = 1099511628211ull;
+
+void fnv1a(std::uint64_t& h, const char* p, std::size_t n) {
+  for (std::size_t i = 0; i < n; ++i) {
+    h ^= (unsigned char)p[i];
+    h *= kFnvPrime;
+  }
+}
+
+} // namespace
+
+std::string hashSourceFile(const std::string& path, const std::vector<std::string>& args) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return "";
+
+  std::uint64_t h = kFnvOffset;
+
+  char buf[1 << 16];
+  while (in) {
+    in.read(buf, sizeof(buf));
+    fnv1a(h, buf, (std::size_t)in.gcount());
+  }
+
+  for (const auto& a : args) {
+    fnv1a(h, "\0", 1);
+    fnv1a(h, a.data(), a.size());
+  }
+
+  char hex[17];
+  std::snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)h);
+  return hex;
+}
+
+std::string FileHashCache::get(const std::string& path) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto it = hashes_.find(path);
+  if (it == hashes_.end()) it = hashes_.emplace(path, hashSourceFile(path, {})).first;
+  return it->second;
+}
+
+std::string normalizeSourcePath(const std::string& path) {
+  std::error_code ec;
+  auto abs = std::filesystem::absolute(path, ec);
+  if (ec) return path;
+  return abs.lexically_normal().generic_string();
+}
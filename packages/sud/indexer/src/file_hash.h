@@ -0,0 +1,29 @@
+#pragma once
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/*
+ * Content hash for incremental indexing (FNV-1a 64, hex).
+ * Compile args are folded in, so a flag change also re-indexes the TU.
+ * Returns "" if the file cannot be read.
+ */
+std::string hashSourceFile(const std::string& path, const std::vector<std::string>& args);
+
+// key used in sud_file.path (absolute, normalized, '/' separators)
+std::string normalizeSourcePath(const std::string& path);
+
+/*
+ * Content hashes of headers (no flags), each read once per run:
+ * many TUs include the same headers. Thread safe.
+ */
+class FileHashCache {
+public:
+  std::string get(const std::string& path);
+
+private:
+  std::mutex mu_;
+  std::unordered_map<std::string, std::string> hashes_;
+};
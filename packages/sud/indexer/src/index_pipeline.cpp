@@ -0,0 +1,134 @@
+#include "index_pipeline.h"
+
+#include <exception>
+#include <utility>
+
+/* ============================================================
+ * Constructor / Destructor
+ * ============================================================ */
+
+IndexPipeline::IndexPipeline(unsigned jobs, Sink sink, PchCache* pch)
+  : sink_(std::move(sink)), pch_(pch)
+{
+  if (jobs == 0) jobs = std::thread::hardware_concurrency();
+  if (jobs == 0) jobs = 1;
+  window_ = kWindowPerJob * jobs;
+
+  workers_.reserve(jobs);
+  for (unsigned i = 0; i < jobs; ++i)
+    workers_.emplace_back(&IndexPipeline::workerLoop, this);
+
+  writer_ = std::thread(&IndexPipeline::writerLoop, this);
+}
+
+IndexPipeline::~IndexPipeline()
+{
+  finish();
+}
+
+/* ============================================================
+ * Producer side
+ * ============================================================ */
+
+void IndexPipeline::submit(ClangTUInput in, IRFile file)
+{
+  {
+    std::unique_lock<std::mutex> lk(resMu_);
+    spaceCv_.wait(lk, [&] { return submitted_ - written_ < window_; });
+    ++submitted_;
+  }
+  {
+    std::lock_guard<std::mutex> lk(jobMu_);
+    jobs_.push_back(Job{ nextSeq_++, std::move(in), std::move(file) });
+  }
+  jobCv_.notify_one();
+}
+
+void IndexPipeline::finish()
+{
+  if (finished_) return;
+  finished_ = true;
+
+  {
+    std::lock_guard<std::mutex> lk(jobMu_);
+    closed_ = true;
+  }
+  jobCv_.notify_all();
+  for (auto& t : workers_) t.join();
+
+  {
+    std::lock_guard<std::mutex> lk(resMu_);
+    inputDone_ = true;
+  }
+  resCv_.notify_all();
+  writer_.join();
+}
+
+/* ============================================================
+ * Parse workers
+ * ============================================================ */
+
+void IndexPipeline::workerLoop()
+{
+  // one extractor (and therefore one CXIndex) per worker thread
+  ClangExtractor extractor(pch_);
+
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lk(jobMu_);
+      jobCv_.wait(lk, [&] { return closed_ || !jobs_.empty(); });
+      if (jobs_.empty()) return;
+      job = std::move(jobs_.front());
+      jobs_.pop_front();
+    }
+
+    IndexResult r;
+    r.seq = job.seq;
+    r.file = job.in.sourcePath;
+    try {
+      r.tu = extractor.parse(job.in);
+      r.tu.file = std::move(job.file);
+    } catch (const std::exception& e) {
+      r.error = e.what();
+    }
+
+    {
+      std::lock_guard<std::mutex> lk(resMu_);
+      ready_.emplace(r.seq, std::move(r));
+    }
+    resCv_.notify_all();
+  }
+}
+
+/* ============================================================
+ * Writer (single thread, submission order)
+ * ============================================================ */
+
+void IndexPipeline::writerLoop()
+{
+  std::size_t next = 0;
+
+  for (;;) {
+    IndexResult r;
+    {
+      std::unique_lock<std::mutex> lk(resMu_);
+      resCv_.wait(lk, [&] {
+        return ready_.count(next) || (inputDone_ && next == submitted_);
+      });
+      auto it = ready_.find(next);
+      if (it == ready_.end()) return;
+      r = std::move(it->second);
+      ready_.erase(it);
+    }
+
+    sink_(r);
+    ++next;
+
+    {
+      std::lock_guard<std::mutex> lk(resMu_);
+      written_ = next;
+    }
+    spaceCv_.notify_one();
+  }
+}
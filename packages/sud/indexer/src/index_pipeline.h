@@ -0,0 +1,93 @@
+#pragma once
+
+#include "extractor_clang.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * ============================================================
+ * Index Pipeline
+ * - N parse workers (each with its own ClangExtractor / CXIndex)
+ * - 1 writer thread that drains results in submission order
+ *   (output is identical to a serial run)
+ * - at most kWindowPerJob * N TUs in flight (queued, parsing or
+ *   waiting for the writer): submit() blocks until the writer
+ *   catches up, so a slow TU at the head of the order cannot make
+ *   every later parsed TU pile up in memory
+ * ============================================================
+ */
+
+struct IndexResult {
+  std::size_t seq = 0;          // submission order
+  std::string file;
+  IRTranslationUnit tu;
+  std::string error;            // non-empty -> parse failed
+};
+
+class IndexPipeline {
+public:
+  using Sink = std::function<void(IndexResult&)>;
+
+  // jobs == 0 -> std::thread::hardware_concurrency()
+  // pch: optional shared prefix-header cache (not owned)
+  IndexPipeline(unsigned jobs, Sink sink, PchCache* pch = nullptr);
+  ~IndexPipeline();
+
+  IndexPipeline(const IndexPipeline&) = delete;
+  IndexPipeline& operator=(const IndexPipeline&) = delete;
+
+  // file: incremental-indexing key, copied into IndexResult::tu.file
+  // blocks while the in-flight window is full
+  void submit(ClangTUInput in, IRFile file = {});
+
+  // close input, wait for every submitted TU to be written
+  void finish();
+
+  unsigned jobs() const { return (unsigned)workers_.size(); }
+
+private:
+  static constexpr std::size_t kWindowPerJob = 4;
+
+  struct Job {
+    std::size_t seq;
+    ClangTUInput in;
+    IRFile file;
+  };
+
+  void workerLoop();
+  void writerLoop();
+
+  Sink sink_;
+  PchCache* pch_;
+
+  /* job queue (main -> workers) */
+  std::mutex jobMu_;
+  std::condition_variable jobCv_;
+  std::deque<Job> jobs_;
+  bool closed_ = false;
+  std::size_t nextSeq_ = 0;
+
+  /* reorder buffer (workers -> writer) */
+  std::mutex resMu_;
+  std::condition_variable resCv_;
+  std::map<std::size_t, IndexResult> ready_;
+  std::size_t submitted_ = 0;
+  std::size_t written_ = 0;
+  bool inputDone_ = false;
+
+  /* backpressure (writer -> producer) */
+  std::condition_variable spaceCv_;
+  std::size_t window_ = 0;
+
+  std::vector<std::thread> workers_;
+  std::thread writer_;
+  bool finished_ = false;
+};
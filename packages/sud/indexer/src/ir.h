@@ -26,10 +26,27 @@ struct IRCall {
   std::string calleeName;
   std::string filePath;
   int line = 0;
-  std::string callType;
+  std::string callType;     // "direct" | "indirect" (calleeUSR = called-through cell)
+};
+
+// function pointer assignment (points-to input, see SudPtrFact for cell keys)
+struct IRPointerFact {
+  std::string cell;         // assigned cell
+  std::string source;       // function USR (address) or copied cell
+  std::string name;         // function name (address)
+  bool address = false;
+};
+
+struct IRTimings {
+  double parseMs = 0.0;   // clang frontend (single parse, bodies included)
+  double visitMs = 0.0;   // cursor walk
 };
 
 struct IRTranslationUnit {
+  IRFile file;              // normalized path + content hash (incremental indexing)
   std::vector<IRFunction> functions;
   std::vector<IRCall> calls;
+  std::vector<IRPointerFact> pointerFacts;
+  std::vector<std::string> includes;   // every header the parse read (as clang names it)
+  IRTimings timings;
 };
@@ -1,20 +1,61 @@
+#include <algorithm>
+#include <filesystem>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <string>
 
 /* indexer only */
 #include "extractor_clang.h"
+#include "index_pipeline.h"
+#include "file_hash.h"
+#include "compile_db.h"
+#include "pch_cache.h"
 
-/* common storage */
+/* common */
+#include "profile/Profiler.h"
 #include "storage/SqliteStore.h"
+#include "graph/Reachability.h"
+#include "graph/PointsTo.h"
 
 static void usage() {
   std::cout <<
-    "sud-indexer --db <sud.db> [--src <file.c> ...] [--dir <path>] -- <clang-args>\n"
+    "sud-indexer --db <sud.db> [--src <file.c> ...] [--dir <path>] [--compdb <path>]\n"
+    "            [--ext .c,.cc] [--jobs N] [--force] [--pch <prefix.h>]\n"
+    "            [--stats[=json]] [--trace <file>] -- <clang-args>\n"
+    "\n"
+    "options:\n"
+    "  --dir P     index every source file under P (recursive, streamed to the workers)\n"
+    "  --compdb P  per-file flags from compile_commands.json (file or its directory);\n"
+    "              with no --src/--dir, every entry of the database is indexed.\n"
+    "              clang-args after -- are appended to the database flags\n"
+    "  --ext L     comma separated extensions picked up by --dir (default .c)\n"
+    "  --jobs N    parse N translation units in parallel (0 = all cores, default 1)\n"
+    "  --force     re-index every file; by default a file is skipped when its content,\n"
+    "              flags and every header it included are unchanged. Tracked files\n"
+    "              that no longer exist are removed from the DB\n"
+    "  --pch H     precompile prefix header H once per flag set and parse every TU\n"
+    "              with -include-pch (cache: <db dir>/<db name>.pch/)\n"
+    "  --stats     per-phase timings, counters and peak RSS on stderr (text, or =json)\n"
+    "  --trace F   write Chrome trace-event JSON (one track per worker) to F\n"
     "\n"
     "examples:\n"
     "  sud-indexer --db sud.db --src sample.c -- -std=c11 -Iinclude\n"
-    "  sud-indexer --db sud.db --dir ./src -- -std=c11\n";
+    "  sud-indexer --db sud.db --dir ./src -- -std=c11\n"
+    "  sud-indexer --db sud.db --compdb build/compile_commands.json --jobs 0\n"
+    "  sud-indexer --db sud.db --jobs 8 --src a.c --src b.c -- -std=c11\n";
+}
+
+// --jobs: unsigned decimal only (stoul throws on text and wraps "-1")
+static bool parseJobs(const std::string& s, unsigned& out) {
+  if (s.empty() || s.size() > 5 || s.find_first_not_of("0123456789") != std::string::npos)
+    return false;
+  out = (unsigned)std::stoul(s);
+  return true;
 }
 
 int main(int argc, char** argv) {
@@ -22,6 +63,11 @@ int main(int argc, char** argv) {
   std::vector<std::string> srcFiles;
   std::string srcDir;
   std::vector<std::string> clangArgs;
+  std::string compdbPath;
+  std::vector<std::string> extensions = { ".c" };
+  unsigned jobs = 1;
+  bool force = false;
+  std::string pchHeader;
 
   bool passClangArgs = false;
 
@@ -49,38 +95,97 @@ int main(int argc, char** argv) {
         srcDir = argv[++i];
         continue;
       }
+      if (a == "--compdb" && i + 1 < argc) {
+        compdbPath = argv[++i];
+        continue;
+      }
+      if (a == "--ext" && i + 1 < argc) {
+        extensions.clear();
+        std::stringstream ss(argv[++i]);
+        std::string e;
+        while (std::getline(ss, e, ',')) {
+          if (e.empty()) continue;
+          extensions.push_back(e[0] == '.' ? e : "." + e);
+        }
+        continue;
+      }
+      if (a == "--jobs" && i + 1 < argc) {
+        if (!parseJobs(argv[++i], jobs)) {
+          usage();
+          return 1;
+        }
+        continue;
+      }
+      if (a == "--pch" && i + 1 < argc) {
+        pchHeader = argv[++i];
+        continue;
+      }
+      if (a == "--force") {
+        force = true;
+        continue;
+      }
       if (a == "--help" || a == "-h") {
         usage();
         return 0;
       }
+      if (Profiler::instance().parseArg(argc, argv, i)) {
+        continue;
+      }
     } else {
       clangArgs.emplace_back(a);
     }
   }
 
-  if (dbPath.empty() || (srcFiles.empty() && srcDir.empty())) {
+  if (dbPath.empty() || (srcFiles.empty() && srcDir.empty() && compdbPath.empty())) {
     usage();
     return 1;
   }
 
+  // extra args appended to compdb flags (kept verbatim, may be empty)
+  const std::vector<std::string> extraArgs = clangArgs;
+
   if (clangArgs.empty()) {
     clangArgs = { "-x", "c", "-std=c11" };
   }
 
+  std::unique_ptr<CompileDb> compdb;
+  if (!compdbPath.empty()) {
+    try {
+      compdb = std::make_unique<CompileDb>(compdbPath);
+    } catch (const std::exception& e) {
+      std::cerr << e.what() << "\n";
+      return 1;
+    }
+  }
+
   /* ------------------------------------------------------------
    * DB init
    * ------------------------------------------------------------ */
   SqliteStore store(dbPath);
   store.initSchema();
 
-  ClangExtractor extractor;
+  // WAL + synchronous=NORMAL for the run, durable settings restored at exit
+  SqliteStore::IndexingSession session(store);
+
+  // path -> content hash + included headers of the last successful index
+  const auto knownFiles = store.loadFiles();
+  FileHashCache headerHashes;
+  std::size_t skipped = 0;
+  std::size_t written = 0;
+  std::size_t removed = 0;
 
   /* ------------------------------------------------------------
    * Index files
+   * - workers parse in parallel, the pipeline's writer thread
+   *   is the only one touching the DB (submission order)
    * ------------------------------------------------------------ */
-  auto indexOne = [&](const std::string& file) {
-    ClangTUInput in{ file, clangArgs };
-    IRTranslationUnit tu = extractor.parse(in);
+  auto writeOne = [&](IndexResult& r) {
+    if (!r.error.empty()) {
+      std::cerr << "[FAIL] " << r.file << " : " << r.error << "\n";
+      return;
+    }
+
+    const IRTranslationUnit& tu = r.tu;
 
     std::vector<SudFunction> funcs;
     funcs.reserve(tu.functions.size());
@@ -92,38 +197,204 @@ int main(int argc, char** argv) {
       });
     }
 
+    // the extractor emits each body's calls in source order: seq counts per caller;
+    // calls through a pointer become facts, resolved once every file is indexed
     std::vector<SudCall> calls;
+    std::vector<SudPtrFact> facts;
     calls.reserve(tu.calls.size());
+    std::unordered_map<std::string, int> seqOf;
     for (const auto& c : tu.calls) {
+      const int seq = seqOf[c.callerUSR]++;
+      if (c.callType == "indirect") {
+        facts.push_back(SudPtrFact{ SudPtrFactKind::Call, c.calleeUSR, c.callerUSR, c.callerName, c.line, seq });
+        continue;
+      }
       calls.push_back(SudCall{
         c.callerUSR,
-        c.calleeUSR
+        c.calleeUSR,
+        c.callerName,
+        c.calleeName,
+        c.line,
+        seq
+      });
+    }
+    for (const auto& f : tu.pointerFacts) {
+      facts.push_back(SudPtrFact{
+        f.address ? SudPtrFactKind::Address : SudPtrFactKind::Copy,
+        f.cell,
+        f.source,
+        f.name
       });
     }
 
-    store.insertFunctions(funcs);
-    store.insertCalls(calls);
+    SudFile file{ tu.file.path, tu.file.hash, {} };
+    std::vector<std::string> includes;
+    includes.reserve(tu.includes.size());
+    for (const auto& h : tu.includes) includes.push_back(normalizeSourcePath(h));
+    std::sort(includes.begin(), includes.end());
+    includes.erase(std::unique(includes.begin(), includes.end()), includes.end());
+    for (auto& h : includes) {
+      std::string hash = headerHashes.get(h);
+      file.deps.push_back(SudFileDep{ std::move(h), std::move(hash) });
+    }
 
-    std::cout << "[OK] " << file
+    try {
+      store.replaceFile(file, funcs, calls, facts);
+      ++written;
+    } catch (const std::exception& e) {
+      std::cerr << "[FAIL] " << r.file << " : " << e.what() << "\n";
+      return;
+    }
+
+    std::cout << "[OK] " << r.file
               << " (functions=" << funcs.size()
-              << ", calls=" << calls.size() << ")\n";
+              << ", calls=" << calls.size()
+              << ", pointer facts=" << facts.size()
+              << std::fixed << std::setprecision(1)
+              << ", parse=" << tu.timings.parseMs << "ms"
+              << ", visit=" << tu.timings.visitMs << "ms)\n"
+              << std::defaultfloat;
+  };
+
+  // opt-in shared prefix header, cached next to the DB
+  std::unique_ptr<PchCache> pch;
+  if (!pchHeader.empty()) {
+    namespace fs = std::filesystem;
+    const fs::path db(dbPath);
+    pch = std::make_unique<PchCache>(
+      pchHeader, (db.parent_path() / (db.stem().string() + ".pch")).string());
+  }
+
+  IndexPipeline pipeline(jobs, writeOne, pch.get());
+
+  // each file is submitted once; unchanged files (same content + flags,
+  // same headers) are skipped without parsing
+  std::unordered_set<std::string> seen;
+
+  auto depsUnchanged = [&](const SudFile& known) {
+    for (const auto& d : known.deps) {
+      if (headerHashes.get(d.path) != d.hash) return false;
+    }
+    return true;
+  };
+
+  auto submitOne = [&](const std::string& file, const std::vector<std::string>& args) {
+    IRFile key{ normalizeSourcePath(file), "" };
+    if (!seen.insert(key.path).second) return;
+
+    key.hash = hashSourceFile(file, args);
+
+    if (!force && !key.hash.empty()) {
+      auto it = knownFiles.find(key.path);
+      if (it != knownFiles.end() && it->second.hash == key.hash && depsUnchanged(it->second)) {
+        ++skipped;
+        return;
+      }
+    }
+
+    pipeline.submit(ClangTUInput{ file, args }, std::move(key));
+  };
+
+  // per-file flags: compdb entry (+ extra args), else the CLI/default flags
+  auto argsFor = [&](const std::string& file) {
+    std::vector<std::string> args;
+    if (compdb && compdb->lookup(file, args)) {
+      args.insert(args.end(), extraArgs.begin(), extraArgs.end());
+      return args;
+    }
+    return clangArgs;
   };
 
   /* explicit file list */
   for (const auto& f : srcFiles) {
-    try {
-      indexOne(f);
-    } catch (const std::exception& e) {
-      std::cerr << "[FAIL] " << f << " : " << e.what() << "\n";
+    submitOne(f, argsFor(f));
+  }
+
+  /* directory scan: files go to the workers as soon as they are found */
+  if (!srcDir.empty()) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::recursive_directory_iterator it(srcDir, fs::directory_options::skip_permission_denied, ec);
+    if (ec) {
+      std::cerr << "[FAIL] " << srcDir << " : " << ec.message() << "\n";
+    }
+
+    for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+      if (!it->is_regular_file(ec)) continue;
+
+      const std::string ext = it->path().extension().string();
+      bool match = false;
+      for (const auto& e : extensions) match = match || (ext == e);
+      if (!match) continue;
+
+      const std::string file = it->path().string();
+      submitOne(file, argsFor(file));
     }
   }
 
-  /* ------------------------------------------------------------
-   * NOTE:
-   * Directory scan intentionally omitted here.
-   * (Add later if needed — architecture is ready.)
-   * ------------------------------------------------------------ */
+  /* compilation database only: every entry */
+  if (compdb && srcFiles.empty() && srcDir.empty()) {
+    for (auto& entry : compdb->all()) {
+      entry.args.insert(entry.args.end(), extraArgs.begin(), extraArgs.end());
+      submitOne(entry.file, entry.args);
+    }
+  }
+
+  pipeline.finish();
+
+  /* tracked files deleted from disk: their functions / calls go too */
+  {
+    namespace fs = std::filesystem;
+    std::vector<std::string> gone;
+    for (const auto& kv : knownFiles) {
+      std::error_code ec;
+      if (!seen.count(kv.first) && !fs::exists(kv.first, ec) && !ec) gone.push_back(kv.first);
+    }
+    std::sort(gone.begin(), gone.end());
+    for (const auto& path : gone) {
+      if (!store.removeFile(path)) continue;
+      ++removed;
+      std::cout << "[DEL] " << path << "\n";
+    }
+  }
 
-  std::cout << "Indexing finished. DB = " << dbPath << "\n";
+  if (written > 0 || removed > 0) {
+    // one file's assignments can change the targets of another file's calls
+    const std::size_t indirect = refreshIndirectCalls(store);
+    std::cout << "Indirect calls resolved: " << indirect << " edges\n";
+
+    store.pruneStubs();
+
+    // a reachability index already in use is kept current; rewritten
+    // only if the change reached the condensation
+    if (store.reachGeneration() >= 0) {
+      const bool rebuilt = refreshReachIndex(store);
+      std::cout << "Reachability index " << (rebuilt ? "rebuilt" : "still valid")
+                << " (generation " << store.generation() << ")\n";
+    }
+  }
+
+  if (pch) {
+    const std::size_t hits = pch->hits();
+    const std::size_t total = hits + pch->misses();
+    std::cout << "PCH cache: hits=" << hits << ", misses=" << (total - hits)
+              << ", hit rate=" << std::fixed << std::setprecision(1)
+              << (total ? 100.0 * hits / total : 0.0) << "%\n"
+              << std::defaultfloat;
+  }
+
+  std::cout << "Indexing finished. DB = " << dbPath
+            << " (indexed=" << written << ", unchanged=" << skipped
+            << ", removed=" << removed << ")\n";
+
+  Profiler& prof = Profiler::instance();
+  prof.count("tu.indexed", (std::int64_t)written);
+  prof.count("tu.unchanged", (std::int64_t)skipped);
+  prof.count("tu.removed", (std::int64_t)removed);
+  if (pch) {
+    prof.count("pch.hits", (std::int64_t)pch->hits());
+    prof.count("pch.misses", (std::int64_t)pch->misses());
+  }
+  prof.report();
   return 0;
 }
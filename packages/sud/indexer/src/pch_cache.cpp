@@ -0,0 +1,181 @@
+#include "pch_cache.h"
+
+#include "file_hash.h"
+#include "profile/Profiler.h"
+
+#include <clang-c/Index.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace fs = std::filesystem;
+
+/* ============================================================
+ * Constructor
+ * ============================================================ */
+
+PchCache::PchCache(std::string prefixHeader, std::string dir)
+  : header_(normalizeSourcePath(prefixHeader)), dir_(std::move(dir))
+{
+  std::error_code ec;
+  fs::create_directories(dir_, ec);
+}
+
+/* ============================================================
+ * Lookup
+ * ============================================================ */
+
+std::string PchCache::keyFor(const std::vector<std::string>& args) const
+{
+  return hashSourceFile(header_, args);
+}
+
+std::string PchCache::acquire(const std::vector<std::string>& args,
+                              std::vector<std::string>* headers)
+{
+  const std::string key = keyFor(args);
+  if (key.empty()) return ""; // prefix header unreadable
+
+  // held while building: workers with the same flags wait for one build
+  std::lock_guard<std::mutex> lk(mu_);
+
+  auto it = ready_.find(key);
+  if (it != ready_.end()) {
+    if (it->second.path.empty()) {
+      ++misses_;
+    } else {
+      ++hits_;
+      if (headers) headers->insert(headers->end(), it->second.headers.begin(), it->second.headers.end());
+    }
+    return it->second.path;
+  }
+
+  const std::string path = (fs::path(dir_) / (key + ".pch")).string();
+
+  std::error_code ec;
+  if (fs::exists(path, ec)) {
+    ++hits_;  // built by an earlier run
+  } else {
+    ++misses_;
+    if (!build(args, path)) {
+      std::cerr << "[PCH] build failed for " << header_ << ", parsing without PCH\n";
+      ready_[key] = Entry{};
+      return "";
+    }
+  }
+
+  Entry& e = ready_[key];
+  e.path = path;
+  e.headers = readHeaders(path);
+  if (headers) headers->insert(headers->end(), e.headers.begin(), e.headers.end());
+  return path;
+}
+
+std::vector<std::string> PchCache::readHeaders(const std::string& pchPath) const
+{
+  // a PCH from before the .deps file: the prefix header is all we know
+  std::vector<std::string> out;
+  std::ifstream in(pchPath + ".deps");
+  for (std::string line; std::getline(in, line);) {
+    if (!line.empty()) out.push_back(line);
+  }
+  if (out.empty()) out.push_back(header_);
+  return out;
+}
+
+void PchCache::invalidate(const std::vector<std::string>& args)
+{
+  const std::string key = keyFor(args);
+
+  std::lock_guard<std::mutex> lk(mu_);
+  auto it = ready_.find(key);
+  if (it == ready_.end() || it->second.path.empty()) return;
+
+  std::error_code ec;
+  fs::remove(it->second.path, ec);
+  fs::remove(it->second.path + ".deps", ec);
+  ready_.erase(it);
+
+  // the TU that found it unusable parsed without it
+  if (hits_ > 0) --hits_;
+  ++misses_;
+}
+
+std::size_t PchCache::hits() const
+{
+  std::lock_guard<std::mutex> lk(mu_);
+  return hits_;
+}
+
+std::size_t PchCache::misses() const
+{
+  std::lock_guard<std::mutex> lk(mu_);
+  return misses_;
+}
+
+/* ============================================================
+ * Build
+ * ============================================================ */
+
+bool PchCache::build(const std::vector<std::string>& args, const std::string& out) const
+{
+  ScopedTimer timer("pch.build");
+
+  // same flags as the TUs, but the input is a header
+  std::vector<std::string> hargs;
+  std::string lang = "c";
+  for (std::size_t i = 0; i < args.size(); ++i) {
+    if (args[i] == "-x" && i + 1 < args.size()) {
+      lang = args[++i];
+      continue;
+    }
+    hargs.push_back(args[i]);
+  }
+  hargs.insert(hargs.begin(), { "-x", lang + "-header" });
+
+  std::vector<const char*> cargs;
+  cargs.reserve(hargs.size());
+  for (auto& a : hargs) cargs.push_back(a.c_str());
+
+  CXIndex index = clang_createIndex(0, 0);
+  CXTranslationUnit tu = clang_parseTranslationUnit(
+    index,
+    header_.c_str(),
+    cargs.data(),
+    (int)cargs.size(),
+    nullptr,
+    0,
+    CXTranslationUnit_ForSerialization | CXTranslationUnit_Incomplete
+  );
+
+  bool ok = false;
+  if (tu) {
+    // write next to the target and rename: concurrent runs never see half a file
+    const std::string tmp = out + ".tmp";
+    ok = clang_saveTranslationUnit(tu, tmp.c_str(), CXSaveTranslationUnit_None) ==
+         CXSaveError_None;
+
+    // headers inside the PCH, written before the PCH itself appears
+    if (ok) {
+      std::vector<std::string> headers;
+      clang_getInclusions(tu, [](CXFile file, CXSourceLocation*, unsigned, CXClientData data) {
+        CXString name = clang_getFileName(file);
+        if (clang_getCString(name)) static_cast<std::vector<std::string>*>(data)->push_back(clang_getCString(name));
+        clang_disposeString(name);
+      }, &headers);
+      std::ofstream deps(out + ".deps", std::ios::trunc);
+      for (const auto& h : headers) deps << h << "\n";
+      ok = (bool)deps;
+    }
+
+    std::error_code ec;
+    if (ok) fs::rename(tmp, out, ec);
+    if (!ok || ec) {
+      fs::remove(tmp, ec);
+      ok = false;
+    }
+    clang_disposeTranslationUnit(tu);
+  }
+  clang_disposeIndex(index);
+  return ok;
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * ============================================================
+ * PCH cache (opt-in, --pch <prefix header>)
+ * - one precompiled prefix header per distinct compile-flag set
+ * - stored as <dir>/<key>.pch, key = FNV(prefix header content + flags),
+ *   so it is reused by later runs and rebuilt when either changes
+ * - TUs are parsed with -include-pch; a PCH clang refuses to load
+ *   (stale transitive header, other libclang) is dropped and rebuilt
+ * - <key>.pch.deps lists the headers the PCH was built from: a TU
+ *   parsed with it does not see them as its own inclusions
+ * Thread-safe: shared by all parse workers.
+ * ============================================================
+ */
+class PchCache {
+public:
+  PchCache(std::string prefixHeader, std::string dir);
+
+  // PCH path to use for a TU with these flags ("" = parse without PCH);
+  // headers: receives the headers inside the PCH (prefix header included)
+  std::string acquire(const std::vector<std::string>& args,
+                      std::vector<std::string>* headers = nullptr);
+
+  // clang could not load it: delete, rebuild on next acquire
+  void invalidate(const std::vector<std::string>& args);
+
+  std::size_t hits() const;
+  std::size_t misses() const;
+
+private:
+  struct Entry {
+    std::string path;                  // "" = build failed
+    std::vector<std::string> headers;
+  };
+
+  std::string keyFor(const std::vector<std::string>& args) const;
+  bool build(const std::vector<std::string>& args, const std::string& out) const;
+  std::vector<std::string> readHeaders(const std::string& pchPath) const;
+
+  std::string header_;
+  std::string dir_;
+
+  mutable std::mutex mu_;
+  std::map<std::string, Entry> ready_; // key -> pch
+  std::size_t hits_ = 0;
+  std::size_t misses_ = 0;
+};